@@ -0,0 +1,183 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_BLOCK_SEARCH_HPP
+#define TURBO_BLOCK_SEARCH_HPP
+
+#include "common_solving.hpp"
+#include <cuda/std/chrono>
+
+/** The search of a block solving the subproblems of the EPS, shared by `gpu_solve_kernel` (`BlockData` and `GridData`) and its emulation on CPU (`EmulatedBlockData` and `EmulatedGridData`).
+ * On GPU, all the threads of the block call these functions, but only the first thread of the block (`is_block_leader`) searches, the others only propagate in `fp_engine`.
+ * On CPU, the block is a single thread (the threads of `AsynchronousIterationCPU` only propagate), hence it is always the leader, and `fp_engine.barrier()` does nothing.
+ *
+ * They are prefixed by `block_` to avoid any confusion with the functions of the same name used by the CPU workers (e.g. `propagate` in cpu_parallel.hpp).
+ *
+ * A block `Block<S>` must provide `root` (the problem, a pointer to `BlockCP`), `subproblem_idx`, `fp_engine` (a pointer to the fixpoint engine), the flags `stop` and `has_changed` shared by the threads of the block (pointers to a `BInc`), and the types `U0` (the universe local to one thread) and `allocator_type` (to interpret the best bound).
+ * A grid `Grid<S>` must provide `root` (for its configuration), `cpu_stop`, `gpu_stop` (a pointer to a `BInc`), `best_bound` (a pointer to a universe shared by all the blocks) and `produce_solution(bab)`.
+ */
+
+CUDA inline bool is_block_leader() {
+#ifdef __CUDA_ARCH__
+  return threadIdx.x == 0;
+#else
+  return true;
+#endif
+}
+
+/** We update the bound found by the current block so it is visible to all other blocks.
+ * Note that this operation might not always succeed, which is okay, the best bound is still preserved in `block_data` and then reduced at the end (in `reduce_blocks`).
+ * The worst that can happen is that a best bound is found twice, which does not prevent the correctness of the algorithm.
+ */
+template <template <class> class Block, template <class> class Grid, class S>
+CUDA void update_grid_best_bound(Block<S>& block_data, Grid<S>& grid_data, local::BInc& best_has_changed) {
+  using U0 = typename Block<S>::U0;
+  if(is_block_leader() && block_data.root->bab->is_optimization()) {
+    const auto& bab = block_data.root->bab;
+    auto local_best = bab->optimum().project(bab->objective_var());
+    if(bab->is_maximization()) {
+      grid_data.best_bound->tell_lb(dual<typename U0::LB>(local_best.ub()), best_has_changed);
+    }
+    else {
+      grid_data.best_bound->tell_ub(dual<typename U0::UB>(local_best.lb()), best_has_changed);
+    }
+  }
+}
+
+/** This function updates the best bound of the current block according to the best bound found so far across blocks.
+ * We directly update the store with the best bound.
+ * This function should be called in each node, since the best bound is erased on backtracking (it is not included in the snapshot).
+ */
+template <template <class> class Block, template <class> class Grid, class S>
+CUDA void update_block_best_bound(Block<S>& block_data, Grid<S>& grid_data) {
+  using U0 = typename Block<S>::U0;
+  using allocator_type = typename Block<S>::allocator_type;
+  if(is_block_leader() && block_data.root->bab->is_optimization()) {
+    const auto& bab = block_data.root->bab;
+    VarEnv<allocator_type> empty_env{};
+    auto best_formula = bab->template deinterpret_best_bound<allocator_type>(
+      bab->is_maximization()
+      ? U0(dual<typename U0::UB>(grid_data.best_bound->lb()))
+      : U0(dual<typename U0::LB>(grid_data.best_bound->ub())));
+    IDiagnostics diagnostics;
+    interpret_and_tell(best_formula, empty_env, *block_data.root->store, diagnostics);
+  }
+}
+
+/** Propagate a node of the search tree and process the leaf nodes (failed or solution).
+ * Branching on unknown nodes is a task left to the caller.
+ */
+template <template <class> class Block, template <class> class Grid, class S>
+CUDA bool block_propagate(Block<S>& block_data, Grid<S>& grid_data, local::BInc& thread_has_changed) {
+  bool is_leaf_node = false;
+  auto& cp = *block_data.root;
+  auto& fp_engine = *block_data.fp_engine;
+#ifdef TURBO_PROFILE_MODE
+  cuda::std::chrono::system_clock::time_point start;
+  if(is_block_leader()) {
+    start = cuda::std::chrono::system_clock::now();
+  }
+  fp_engine.barrier();
+#endif
+  size_t iterations = fp_engine.fixpoint(*cp.ipc, thread_has_changed, &grid_data.cpu_stop);
+  if(is_block_leader()) {
+#ifdef TURBO_PROFILE_MODE
+    auto end = cuda::std::chrono::system_clock::now();
+    cuda::std::chrono::duration<double> diff = end - start;
+    cp.stats.propagation_time += diff.count();
+#endif
+    cp.stats.fixpoint_iterations += iterations;
+    cp.on_node();
+    if(cp.ipc->is_top()) {
+      is_leaf_node = true;
+      cp.on_failed_node();
+    }
+    else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
+      is_leaf_node = true;
+      if(cp.bab->is_satisfaction() || cp.bab->compare_bound(*cp.store, cp.bab->optimum())) {
+        cp.bab->refine(thread_has_changed);
+        bool do_not_stop = cp.update_solution_stats();
+        if(!do_not_stop) {
+          grid_data.gpu_stop->tell_top();
+        }
+        local::BInc best_has_changed;
+        update_grid_best_bound(block_data, grid_data, best_has_changed);
+        if(best_has_changed && cp.is_printing_intermediate_sol()) {
+          grid_data.produce_solution(*cp.bab);
+        }
+      }
+    }
+#ifdef TURBO_PROFILE_MODE
+    if(cp.stats.nodes >= cp.config.stop_after_n_nodes) {
+      grid_data.gpu_stop->tell_top();
+    }
+    auto end2 = cuda::std::chrono::system_clock::now();
+    diff = end2 - end;
+    cp.stats.search_time += diff.count();
+#endif
+  }
+  return is_leaf_node;
+}
+
+/** The initial problem tackled during the dive must always be the same.
+ * Hence, don't be tempted to add the objective during diving because it might lead to ignoring some subproblems since the splitting decisions will differ.
+ */
+template <template <class> class Block, template <class> class Grid, class S>
+CUDA size_t block_dive(Block<S>& block_data, Grid<S>& grid_data) {
+  auto& cp = *block_data.root;
+  auto& fp_engine = *block_data.fp_engine;
+  auto& stop = *block_data.stop;
+  // Note that we use `block_has_changed` to stop the "diving", not really to indicate something has changed or not (since we do not need this information for this algorithm).
+  auto& stop_diving = *block_data.has_changed;
+  stop.dtell_bot();
+  stop_diving.dtell_bot();
+  fp_engine.barrier();
+  size_t remaining_depth = grid_data.root.config.subproblems_power;
+  while(remaining_depth > 0 && !stop_diving && !stop) {
+    remaining_depth--;
+    local::BInc thread_has_changed;
+    bool is_leaf_node = block_propagate(block_data, grid_data, thread_has_changed);
+    if(is_block_leader()) {
+      if(is_leaf_node) {
+        stop_diving.tell_top();
+      }
+      else {
+        size_t branch_idx = (block_data.subproblem_idx & (size_t{1} << remaining_depth)) >> remaining_depth;
+        auto branches = cp.eps_split->split();
+        assert(branches.size() == 2);
+        cp.ipc->tell(branches[branch_idx]);
+      }
+      stop.tell(local::BInc(grid_data.cpu_stop || *(grid_data.gpu_stop)));
+    }
+    fp_engine.barrier();
+  }
+  return remaining_depth;
+}
+
+template <template <class> class Block, template <class> class Grid, class S>
+CUDA void block_solve_problem(Block<S>& block_data, Grid<S>& grid_data) {
+  auto& cp = *block_data.root;
+  auto& fp_engine = *block_data.fp_engine;
+  auto& block_has_changed = *block_data.has_changed;
+  auto& stop = *block_data.stop;
+  block_has_changed.tell_top();
+  stop.dtell_bot();
+  fp_engine.barrier();
+  // In the condition, we must only read variables that are local to this block.
+  // Otherwise, two threads might read different values if it is changed in between by another block.
+  while(block_has_changed && !stop) {
+    // For correctness we need this local variable, we cannot use `block_has_changed` (because it might still need to be read by other threads to enter this loop).
+    local::BInc thread_has_changed;
+    update_block_best_bound(block_data, grid_data);
+    block_propagate(block_data, grid_data, thread_has_changed);
+    if(is_block_leader()) {
+      stop.tell(local::BInc(grid_data.cpu_stop || *(grid_data.gpu_stop)));
+      cp.search_tree->refine(thread_has_changed);
+    }
+    block_has_changed.dtell_bot();
+    fp_engine.barrier();
+    block_has_changed.tell(thread_has_changed);
+    fp_engine.barrier();
+  }
+}
+
+#endif
@@ -0,0 +1,450 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_BRANCHING_HPP
+#define TURBO_BRANCHING_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "common_solving.hpp"
+#include "nogoods.hpp"
+
+/** A decision of the depth-first searches exploring the tree by themselves: the snapshot of its right branch, and the bound literals of its left branch. */
+template <class A>
+struct SearchDecision {
+  typename A::IPC::template snapshot_type<bt::standard_allocator> right;
+  std::vector<BoundLiteral> left;
+  bool on_right;
+};
+
+/** Push the decision `left` (left branch) and its negation (right branch) on the stack and enter its left branch. */
+template <class A>
+void push_literal_decision(A& cp, std::vector<SearchDecision<A>>& decisions, const BoundLiteral& left) {
+  auto parent = cp.ipc->template snapshot<bt::standard_allocator>();
+  left.tell_negation(*cp.store);
+  auto right = cp.ipc->template snapshot<bt::standard_allocator>();
+  cp.ipc->restore(parent);
+  left.tell(*cp.store);
+  decisions.push_back({std::move(right), {left}, false});
+}
+
+/** A brancher creates the decision of the current node, pushes it on the stack and enters its left branch.
+ * `branch` returns `false` if there is nothing left to split.
+ * `select` only returns the variable the brancher would split, or `-1`.
+ *
+ * `SplitBrancher` follows the split strategy of the problem (`cp.split`), the left branch is read back from the store (see `branch_literals`).
+ */
+template <class A>
+class SplitBrancher {
+  std::vector<std::pair<int, int>> bounds;
+  std::vector<BoundLiteral> literals;
+
+  void save_bounds(const A& cp) {
+    for(size_t i = 0; i < bounds.size(); ++i) {
+      bounds[i] = {(*cp.store)[i].lb().value(), (*cp.store)[i].ub().value()};
+    }
+  }
+
+public:
+  SplitBrancher(const A& cp): bounds(cp.store->vars()) {}
+
+  int select(A& cp) {
+    auto branches = cp.split->split();
+    if(branches.size() == 0) {
+      return -1;
+    }
+    auto parent = cp.ipc->template snapshot<bt::standard_allocator>();
+    save_bounds(cp);
+    cp.ipc->tell(branches[0]);
+    literals.clear();
+    branch_literals(bounds, *cp.store, literals);
+    cp.ipc->restore(parent);
+    return literals.empty() ? -1 : literals[0].var;
+  }
+
+  bool branch(A& cp, std::vector<SearchDecision<A>>& decisions) {
+    auto branches = cp.split->split();
+    if(branches.size() == 0) {
+      return false;
+    }
+    assert(branches.size() == 2);
+    auto parent = cp.ipc->template snapshot<bt::standard_allocator>();
+    cp.ipc->tell(branches[1]);
+    auto right = cp.ipc->template snapshot<bt::standard_allocator>();
+    cp.ipc->restore(parent);
+    save_bounds(cp);
+    cp.ipc->tell(branches[0]);
+    decisions.push_back({std::move(right), {}, false});
+    branch_literals(bounds, *cp.store, decisions.back().left);
+    return true;
+  }
+};
+
+/** Add to `scope` the index in the store of the variables occurring in `f`. */
+template <class F, class Env>
+void collect_scope(const F& f, const Env& env, std::vector<int>& scope) {
+  switch(f.index()) {
+    case F::V:
+      scope.push_back(f.v().vid());
+      break;
+    case F::LV: {
+      auto x = env.variable_of(f.lv());
+      if(x.has_value()) {
+        scope.push_back(x->avars[0].vid());
+      }
+      break;
+    }
+    case F::Seq:
+      for(size_t i = 0; i < f.seq().size(); ++i) {
+        collect_scope(f.seq(i), env, scope);
+      }
+      break;
+    case F::ESeq:
+      for(size_t i = 0; i < f.eseq().size(); ++i) {
+        collect_scope(f.eseq(i), env, scope);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+/** Only keep in `vars` the variables of the store, once each and in increasing order. */
+inline void normalize_store_variables(std::vector<int>& vars, size_t num_vars) {
+  vars.erase(std::remove_if(vars.begin(), vars.end(),
+    [&](int x) { return x < 0 || static_cast<size_t>(x) >= num_vars; }), vars.end());
+  std::sort(vars.begin(), vars.end());
+  vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+}
+
+/** Compute in `scopes[p]` the variables of the store (without duplicates) over which the propagator `p` of `cp.ipc` is defined, `scopes` must have one element per refinement of `cp.ipc`.
+ * The propagators of `ipc` do not give the variables they are defined on, hence the scopes are computed from the deinterpretation of `ipc`: the conjuncts of the store followed by one conjunct per propagator, in the order of their refinements.
+ * \return `false` if the deinterpretation does not have exactly this number of conjuncts, the scopes are then left empty since the conjuncts cannot be matched to the propagators. */
+template <class A>
+bool propagator_scopes(A& cp, std::vector<std::vector<int>>& scopes) {
+  auto f = cp.ipc->deinterpret(cp.env);
+  using F = decltype(f);
+  auto store_formula = cp.store->deinterpret(cp.env);
+  using SF = decltype(store_formula);
+  size_t first = store_formula.is(SF::Seq) ? store_formula.seq().size() : 1;
+  size_t n = scopes.size();
+  if(!f.is(F::Seq) || f.seq().size() != first + n) {
+    return false;
+  }
+  for(size_t p = 0; p < n; ++p) {
+    collect_scope(f.seq(first + p), cp.env, scopes[p]);
+    normalize_store_variables(scopes[p], cp.store->vars());
+  }
+  return true;
+}
+
+/** Add to `vars` the index in the store of the variables occurring in the search annotations of `f`. */
+template <class F, class Env>
+void collect_search_variables(const F& f, const Env& env, std::vector<int>& vars) {
+  if(f.is(F::Seq)) {
+    for(size_t i = 0; i < f.seq().size(); ++i) {
+      collect_search_variables(f.seq(i), env, vars);
+    }
+  }
+  else if(f.is(F::ESeq) && strcmp(f.esig().data(), "search") == 0) {
+    collect_scope(f, env, vars);
+  }
+}
+
+/** The decision variables of `cp` (without duplicates): the variables of the search annotations of `f`, the formula returned by `preprocess`, or all the variables of the model if it has none (as `interpret_default_strategy`).
+ * The auxiliary variables introduced by the interpretation (e.g. for the reified constraints) are not decision variables. */
+template <class A, class F>
+std::vector<int> decision_variables(const A& cp, const F& f) {
+  std::vector<int> vars;
+  collect_search_variables(f, cp.env, vars);
+  if(vars.empty()) {
+    for(int i = 0; i < cp.env.num_vars(); ++i) {
+      vars.push_back(cp.env[i].avars[0].vid());
+    }
+  }
+  normalize_store_variables(vars, cp.store->vars());
+  return vars;
+}
+
+/** `DomWDegBrancher` selects the variable with the smallest ratio between the size of its domain and its weighted degree, and tries its lower bound first (dom/wdeg, Boussemart et al., "Boosting Systematic Search by Weighting Constraints", 2004).
+ * It is also the fixpoint engine of the search, in order to know which propagator fails: it iterates over the propagators as `GaussSeidelIteration`, and stops as soon as one of them fails.
+ * The weight of a propagator is the number of failures it caused (plus one).
+ * The weighted degree of a variable is the sum of the weights of the propagators over this variable (plus one, for the variables without propagator).
+ * The scopes of the propagators are computed once by `propagator_scopes`.
+ * Only the decision variables (see `decision_variables`) are selected, the other variables of the store are only selected once the decision variables are all assigned, since a solution is only extracted when the whole store is assigned.
+ */
+template <class A>
+class DomWDegBrancher {
+  A& cp;
+  std::vector<size_t> weights;
+  std::vector<std::vector<int>> scopes;
+  std::vector<size_t> wdeg;
+  std::vector<int> decision_vars;
+  std::vector<int> store_vars;
+
+  void init_scopes() {
+    if(!propagator_scopes(cp, scopes)) {
+      if(cp.config.verbose_solving) {
+        printf("%% WARNING: The propagators could not be matched to their variables, -var-order dom_w_deg only uses the domain sizes.\n");
+      }
+      return;
+    }
+    for(const auto& scope : scopes) {
+      for(int x : scope) {
+        wdeg[x]++;
+      }
+    }
+  }
+
+  void on_failure(size_t p) {
+    weights[p]++;
+    for(int x : scopes[p]) {
+      wdeg[x]++;
+    }
+  }
+
+  int select_among(A& cp, const std::vector<int>& vars) {
+    int best = -1;
+    double best_score = 0;
+    for(int x : vars) {
+      int lb = (*cp.store)[x].lb().value();
+      int ub = (*cp.store)[x].ub().value();
+      if(lb < ub) {
+        double score = (static_cast<double>(ub) - lb + 1) / wdeg[x];
+        if(best == -1 || score < best_score) {
+          best = x;
+          best_score = score;
+        }
+      }
+    }
+    return best;
+  }
+
+public:
+  DomWDegBrancher(A& cp, std::vector<int> decision_vars)
+    : cp(cp)
+    , weights(cp.ipc->num_refinements(), 1)
+    , scopes(cp.ipc->num_refinements())
+    , wdeg(cp.store->vars(), 1)
+    , decision_vars(std::move(decision_vars))
+    , store_vars(cp.store->vars())
+  {
+    std::iota(store_vars.begin(), store_vars.end(), 0);
+    init_scopes();
+  }
+
+  template <class IPC, class M>
+  size_t fixpoint(IPC& a, BInc<M>& has_changed) {
+    size_t iterations = 0;
+    bool iteration_changed = true;
+    while(iteration_changed && !a.is_top()) {
+      iteration_changed = false;
+      for(size_t i = 0; i < a.num_refinements(); ++i) {
+        local::BInc changed;
+        a.refine(i, changed);
+        if(a.is_top()) {
+          on_failure(i);
+          break;
+        }
+        iteration_changed |= static_cast<bool>(changed);
+      }
+      has_changed.tell(local::BInc(iteration_changed));
+      iterations++;
+    }
+    return iterations;
+  }
+
+  template <class IPC>
+  size_t fixpoint(IPC& a) {
+    local::BInc has_changed;
+    return fixpoint(a, has_changed);
+  }
+
+  int select(A& cp) {
+    int x = select_among(cp, decision_vars);
+    return x == -1 ? select_among(cp, store_vars) : x;
+  }
+
+  bool branch(A& cp, std::vector<SearchDecision<A>>& decisions) {
+    int x = select(cp);
+    if(x == -1) {
+      return false;
+    }
+    push_literal_decision(cp, decisions, {x, true, (*cp.store)[x].lb().value()});
+    return true;
+  }
+};
+
+/** `ActivityBrancher` selects the variable with the largest ratio between its activity and the size of its domain (the smallest domain on ties), and tries its lower bound first (Michel and Van Hentenryck, "Activity-Based Search for Black-Box Constraint Programming Solvers", 2012).
+ * The activity of a variable is bumped each time its domain is narrowed by the propagation, and decays by `ACTIVITY_DECAY` at each node.
+ * As `DomWDegBrancher`, it is also the fixpoint engine of the search: it iterates over the propagators as `GaussSeidelIteration`, and when a propagator changes the store, only the variables of its scope (see `propagator_scopes`) narrowed by this propagator are bumped, hence the decisions themselves do not count as narrowings.
+ * The decay is applied once per node (the first fixpoint of a node sees a new `cp.stats.nodes`), but not to the activities: the bump increment is divided by `ACTIVITY_DECAY` instead (as in the VSIDS heuristic of SAT solvers), and everything is rescaled when it becomes too large.
+ * As `DomWDegBrancher`, the decision variables are selected first.
+ */
+template <class A>
+class ActivityBrancher {
+  A& cp;
+  std::vector<double> activity;
+  std::vector<std::vector<int>> scopes;
+  // The bounds of the variables of a scope before its propagator is refined.
+  std::vector<std::pair<int, int>> before;
+  double increment;
+  size_t node;
+  std::vector<int> decision_vars;
+  std::vector<int> store_vars;
+
+  void rescale() {
+    for(double& a : activity) {
+      a *= ACTIVITY_RESCALE;
+    }
+    increment *= ACTIVITY_RESCALE;
+  }
+
+  void on_refine(size_t p) {
+    const auto& scope = scopes[p];
+    for(size_t i = 0; i < scope.size(); ++i) {
+      if((*cp.store)[scope[i]].lb().value() > before[i].first || (*cp.store)[scope[i]].ub().value() < before[i].second) {
+        activity[scope[i]] += increment;
+      }
+    }
+  }
+
+  int select_among(A& cp, const std::vector<int>& vars) {
+    int best = -1;
+    double best_score = 0;
+    int best_size = 0;
+    for(int x : vars) {
+      int lb = (*cp.store)[x].lb().value();
+      int ub = (*cp.store)[x].ub().value();
+      if(lb < ub) {
+        int size = ub - lb + 1;
+        double score = activity[x] / size;
+        if(best == -1 || score > best_score || (score == best_score && size < best_size)) {
+          best = x;
+          best_score = score;
+          best_size = size;
+        }
+      }
+    }
+    return best;
+  }
+
+public:
+  ActivityBrancher(A& cp, std::vector<int> decision_vars)
+    : cp(cp)
+    , activity(cp.store->vars(), 0)
+    , scopes(cp.ipc->num_refinements())
+    , increment(1)
+    , node(cp.stats.nodes)
+    , decision_vars(std::move(decision_vars))
+    , store_vars(cp.store->vars())
+  {
+    std::iota(store_vars.begin(), store_vars.end(), 0);
+    if(!propagator_scopes(cp, scopes) && cp.config.verbose_solving) {
+      printf("%% WARNING: The propagators could not be matched to their variables, -var-order activity only uses the domain sizes.\n");
+    }
+    size_t max_scope = 0;
+    for(const auto& scope : scopes) {
+      max_scope = std::max(max_scope, scope.size());
+    }
+    before.resize(max_scope);
+  }
+
+  template <class IPC, class M>
+  size_t fixpoint(IPC& a, BInc<M>& has_changed) {
+    if(node != cp.stats.nodes) {
+      node = cp.stats.nodes;
+      increment /= ACTIVITY_DECAY;
+      if(increment > ACTIVITY_MAX_INCREMENT) {
+        rescale();
+      }
+    }
+    size_t iterations = 0;
+    bool iteration_changed = true;
+    while(iteration_changed && !a.is_top()) {
+      iteration_changed = false;
+      for(size_t i = 0; i < a.num_refinements(); ++i) {
+        const auto& scope = scopes[i];
+        for(size_t j = 0; j < scope.size(); ++j) {
+          before[j] = {(*cp.store)[scope[j]].lb().value(), (*cp.store)[scope[j]].ub().value()};
+        }
+        local::BInc changed;
+        a.refine(i, changed);
+        if(changed) {
+          on_refine(i);
+        }
+        if(a.is_top()) {
+          break;
+        }
+        iteration_changed |= static_cast<bool>(changed);
+      }
+      has_changed.tell(local::BInc(iteration_changed));
+      iterations++;
+    }
+    return iterations;
+  }
+
+  template <class IPC>
+  size_t fixpoint(IPC& a) {
+    local::BInc has_changed;
+    return fixpoint(a, has_changed);
+  }
+
+  int select(A& cp) {
+    int x = select_among(cp, decision_vars);
+    return x == -1 ? select_among(cp, store_vars) : x;
+  }
+
+  bool branch(A& cp, std::vector<SearchDecision<A>>& decisions) {
+    int x = select(cp);
+    if(x == -1) {
+      return false;
+    }
+    push_literal_decision(cp, decisions, {x, true, (*cp.store)[x].lb().value()});
+    return true;
+  }
+};
+
+/** `SolutionGuidedBrancher` branches on the variable selected by `brancher`, but tries its value `v` in the best solution first (solution-guided search, Beck, "Solution-Guided Multi-Point Constructive Search for Job Shop Scheduling", 2007).
+ * Since the right branch `x != v` is not an interval, two decisions are pushed at once: `x >= v` (right branch `x <= v - 1`) and then `x <= v` (right branch `x >= v + 1`).
+ * The values `x < v` and `x > v` are therefore explored when `x = v` fails.
+ * Before the first solution, `brancher` decides alone, and if `v` is not in the domain of `x` anymore, its lower bound is tried first.
+ */
+template <class A, class Brancher>
+class SolutionGuidedBrancher {
+  Brancher& brancher;
+
+public:
+  SolutionGuidedBrancher(Brancher& brancher): brancher(brancher) {}
+
+  bool branch(A& cp, std::vector<SearchDecision<A>>& decisions) {
+    if(cp.stats.solutions == 0) {
+      return brancher.branch(cp, decisions);
+    }
+    int x = brancher.select(cp);
+    if(x == -1) {
+      return false;
+    }
+    int lb = (*cp.store)[x].lb().value();
+    int ub = (*cp.store)[x].ub().value();
+    int v = (*cp.best)[x].lb().value();
+    if(v < lb || v > ub) {
+      push_literal_decision(cp, decisions, {x, true, lb});
+      return true;
+    }
+    if(v > lb) {
+      push_literal_decision(cp, decisions, {x, false, v});
+    }
+    if(v < ub) {
+      push_literal_decision(cp, decisions, {x, true, v});
+    }
+    cp.stats.guided_decisions++;
+    return true;
+  }
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include <chrono>
 #include <thread>
 #include <csignal>
+#include <cstring>
 
 #include "config.hpp"
 #include "statistics.hpp"
@@ -201,6 +202,7 @@ struct AbstractDomains {
    , search_tree(basic_allocator)
    , best(basic_allocator)
    , bab(basic_allocator)
+   , live(nullptr)
   {
     AbstractDeps<BasicAllocator, PropAllocator, StoreAllocator> deps{enable_sharing, basic_allocator, prop_allocator, store_allocator};
     store = deps.template clone<IStore>(other.store);
@@ -251,6 +253,7 @@ struct AbstractDomains {
   , search_tree(basic_allocator)
   , best(basic_allocator)
   , bab(basic_allocator)
+  , live(nullptr)
   {}
 
   AbstractDomains(AbstractDomains&& other) = default;
@@ -276,6 +279,8 @@ struct AbstractDomains {
 
   Configuration<BasicAllocator> config;
   Statistics stats;
+  // The slot of this copy in a `StatisticsRegistry`, if the statistics are read while solving.
+  LiveStatistics* live;
 
   CUDA void allocate(int num_vars) {
     env = VarEnv<basic_allocator_type>{basic_allocator};
@@ -345,8 +350,10 @@ private:
   }
 
 public:
+  /** Interpret `f` in the abstract domains.
+   * If the model has no search strategy, we use the default one `var_order, val_order` over all the variables (see `interpret_default_strategy`). */
   template <class F>
-  CUDA bool interpret(const F& f) {
+  CUDA bool interpret(const F& f, const char* var_order = "first_fail", const char* val_order = "indomain_min", unsigned int seed = 0) {
     if(config.verbose_solving) {
       printf("%% Interpreting the formula...\n");
     }
@@ -357,7 +364,7 @@ public:
     stats.constraints = ipc->num_refinements();
     bool can_interpret = true;
     if(split->num_strategies() == 0) {
-      can_interpret &= interpret_default_strategy<F>();
+      can_interpret &= interpret_default_strategy<F>(var_order, val_order, seed);
     }
     if(eps_split->num_strategies() == 0) {
       can_interpret &= interpret_default_eps_strategy<F>();
@@ -386,7 +393,7 @@ public:
   }
 
   template <class F>
-  void type_and_interpret(F& f) {
+  void type_and_interpret(F& f, const char* var_order = "first_fail", const char* val_order = "indomain_min", unsigned int seed = 0) {
     if(config.verbose_solving) {
       printf("%% Typing the formula...\n");
     }
@@ -396,7 +403,7 @@ public:
       f.print(true);
       printf("\n");
     }
-    if(!interpret(f)) {
+    if(!interpret(f, var_order, val_order, seed)) {
       exit(EXIT_FAILURE);
     }
 
@@ -448,9 +455,11 @@ public:
     return f;
   }
 
-  void preprocess() {
+  /** \return The formula interpreted in the abstract domains (the simplified formula if the simplification succeeded). */
+  FormulaPtr preprocess() {
     auto raw_formula = prepare_solver();
     auto start = std::chrono::high_resolution_clock::now();
+    FormulaPtr interpreted_formula = raw_formula;
     if(prepare_simplifier(*raw_formula)) {
       GaussSeidelIteration fp_engine;
       fp_engine.fixpoint(*ipc);
@@ -460,23 +469,69 @@ public:
       stats.eliminated_formulas = simplifier->num_eliminated_formulas();
       allocate(num_quantified_vars(f));
       type_and_interpret(f);
+      interpreted_formula = battery::allocate_shared<TFormula<basic_allocator_type>, basic_allocator_type>(basic_allocator, std::move(f));
     }
     auto interpretation_time = std::chrono::high_resolution_clock::now();
     stats.interpretation_duration += std::chrono::duration_cast<std::chrono::milliseconds>(interpretation_time - start).count();
+    return interpreted_formula;
+  }
+
+  /** Interpret in `this` the formula `f` returned by `preprocess` on another copy of the problem, without parsing and simplifying it again.
+   * The variables are interpreted in the same order, so the solutions can be extracted from one copy to the other.
+   * The search annotations of the model are ignored if `ignore_search_annotations` is `true`.
+   * It is used to build differently-configured copies of the problem, for instance in the portfolio.
+   */
+  template <class F>
+  void interpret_variant(F& f, bool ignore_search_annotations, const char* var_order, const char* val_order, unsigned int seed) {
+    if(ignore_search_annotations) {
+      remove_search_annotations(f);
+    }
+    allocate(num_quantified_vars(f));
+    type_and_interpret(f, var_order, val_order, seed);
   }
 
 private:
   template <class F>
-  CUDA bool interpret_default_strategy() {
+  void remove_search_annotations(F& f) {
+    switch(f.index()) {
+      case F::Seq:
+        for(size_t i = 0; i < f.seq().size(); ++i) {
+          remove_search_annotations(f.seq(i));
+        }
+        break;
+      case F::ESeq:
+        if(strcmp(f.esig().data(), "search") == 0) {
+          f = F::make_true();
+        }
+        break;
+    }
+  }
+
+  /** When `seed` is not zero, the variables are shuffled, which changes how the ties of `var_order` are broken. */
+  template <class F>
+  CUDA bool interpret_default_strategy(const char* var_order, const char* val_order, unsigned int seed) {
     if(config.verbose_solving) {
-      printf("%% No split strategy provided, using the default one (first_fail, indomain_min).\n");
+      printf("%% No split strategy provided, using the default one (%s, %s).\n", var_order, val_order);
     }
     config.free_search = true;
     typename F::Sequence seq;
-    seq.push_back(F::make_nary("first_fail", {}));
-    seq.push_back(F::make_nary("indomain_min", {}));
+    seq.push_back(F::make_nary(var_order, {}));
+    seq.push_back(F::make_nary(val_order, {}));
+    battery::vector<int, BasicAllocator> vars(basic_allocator);
     for(int i = 0; i < env.num_vars(); ++i) {
-      seq.push_back(F::make_avar(env[i].avars[0]));
+      vars.push_back(i);
+    }
+    // Fisher-Yates shuffle with a linear congruential generator, since the standard random generators are not available on GPU.
+    unsigned int state = seed;
+    for(size_t i = vars.size(); seed != 0 && i > 1; --i) {
+      state = state * 1103515245u + 12345u;
+      size_t j = state % i;
+      int tmp = vars[i - 1];
+      vars[i - 1] = vars[j];
+      vars[j] = tmp;
+    }
+    for(size_t i = 0; i < vars.size(); ++i) {
+      seq.push_back(F::make_avar(env[vars[i]].avars[0]));
     }
     F search_strat = F::make_nary("search", std::move(seq));
     if(!interpret_and_diagnose_and_tell(search_strat, env, *bab)) {
@@ -502,8 +557,21 @@ private:
 
 public:
   CUDA void on_node() {
+    on_node(search_tree->depth());
+  }
+
+  /** Same as `on_node()`, but for search engines exploring the tree without `search_tree`. */
+  CUDA void on_node(size_t depth) {
     stats.nodes++;
-    stats.depth_max = battery::max(stats.depth_max, search_tree->depth());
+    stats.depth_max = battery::max(stats.depth_max, depth);
+    publish_stats();
+  }
+
+  /** Without `StatisticsRegistry` (e.g. in the sequential searches), `live` is null and it only costs this test. */
+  CUDA void publish_stats() {
+    if(live != nullptr) {
+      live->publish(stats);
+    }
   }
 
   CUDA bool is_printing_intermediate_sol() {
@@ -517,6 +585,7 @@ public:
 
   CUDA bool update_solution_stats() {
     stats.solutions++;
+    publish_stats();
     if(bab->is_satisfaction() && config.stop_after_n_solutions != 0 &&
        stats.solutions >= config.stop_after_n_solutions)
     {
@@ -533,6 +602,7 @@ public:
     return update_solution_stats();
   }
 
+  /** The failures are published with the next node, `on_node` being called before `on_failed_node`. */
   CUDA void on_failed_node() {
     stats.fails += 1;
   }
@@ -547,7 +617,7 @@ public:
   CUDA void print_mzn_statistics() {
     if(config.print_statistics) {
       config.print_mzn_statistics();
-      stats.print_mzn_statistics();
+      stats.print_mzn_statistics(config);
       if(!bab->objective_var().is_untyped() && !best->is_bot()) {
         stats.print_mzn_objective(best->project(bab->objective_var()), bab->is_minimization());
       }
@@ -566,6 +636,8 @@ public:
 };
 
 using Itv = Interval<ZInc<int, battery::local_memory>>;
+// Domain of the variables when the store is refined by several CPU threads at once (see `AsynchronousIterationCPU`).
+using AtomicItv = Interval<ZInc<int, battery::atomic_memory<>>>;
 
 template <class Universe>
 using CP = AbstractDomains<Universe,
@@ -13,12 +13,50 @@
 
 #define SUBPROBLEMS_POWER 12 // 2^N
 #define STACK_KB 32
+#define DETERMINISTIC_EPOCH_NODES 1000
+#define INTERLEAVE_SLICE_NODES 1000
+#define ADAPTIVE_EPS_DEPTH_RANGE 8 // The adaptive EPS can go up to 2^(N+8) subproblems, where N is the initial -sub.
+#define ADAPTIVE_EPS_MAX_SUBPROBLEMS_POWER 40
+#define ADAPTIVE_EPS_MIN_SUBPROBLEMS 4 // per worker.
+#define ADAPTIVE_EPS_MAX_DIVE_RATIO 0.2
+#define ADAPTIVE_EPS_MAX_FAIL_RATE 0.75
+#define LIVE_STATISTICS_PERIOD_MS 1000 // Period of the statistics printed while solving in verbose mode (-v).
+#define AUTO_CALIBRATION_DIVES 32 // Random dives run by `-p 0` to measure the cost of a node.
+#define AUTO_CALIBRATION_MS 200
+#define AUTO_CALIBRATION_MAX_DEPTH 64
+#define AUTO_SUBPROBLEMS_PER_THREAD 32
+#define AUTO_MAX_OVERHEAD_RATIO 0.05 // The copies of the problem and the dives of the EPS must take less than 5% of the timeout.
+#define DISTRIBUTED_RANGE_SIZE 64 // Number of EPS subproblems given at once to a worker thread of the distributed EPS.
+#define DISTRIBUTED_CONNECT_TIMEOUT_MS 60000 // The coordinator of the distributed EPS stops if no worker connected during the first minute.
+#define RESTART_BASE 100 // Number of failures before the first restart.
+#define RESTART_GEOMETRIC_FACTOR 1.5
+#define ACTIVITY_DECAY 0.95
+#define ACTIVITY_MAX_INCREMENT 1e100
+#define ACTIVITY_RESCALE 1e-100
+#define LEARNING_MAX_DECISIONS 64 // Above, a failure is not explained (see `analyse_conflict`).
+#define LEARNING_CHECKS_PER_NODE 4 // The failures are not explained while the conflict checks exceed 4 per node explored (see `analyse_conflict`).
+#define LNS_INITIAL_RELAX 0.2 // Ratio of the variables not fixed in a neighbourhood of the LNS.
+#define LNS_MIN_RELAX 0.02
+#define LNS_MAX_RELAX 0.9
+#define LNS_RELAX_GROWTH 1.2
 
 enum class Arch {
   CPU,
   GPU
 };
 
+enum class RestartStrategy {
+  NONE,
+  LUBY,
+  GEOMETRIC
+};
+
+enum class VarOrder {
+  SPLIT, // The split strategy of the model, or the default one (see `interpret_default_strategy`).
+  DOM_WDEG,
+  ACTIVITY
+};
+
 enum class InputFormat {
   XCSP3,
   FLATZINC
@@ -38,13 +76,32 @@ struct Configuration {
   bool noatomics;
   size_t timeout_ms;
   size_t or_nodes;
-  size_t and_nodes; // (only for GPU)
+  bool auto_threads; // `-p 0` on CPU: `or_nodes` and `subproblems_power` are chosen by `calibrate_cpu_threads`.
+  size_t and_nodes; // On CPU, only used by sequential solving.
   size_t subproblems_power;
   size_t stack_kb;
+  bool work_stealing; // (only for CPU)
+  size_t portfolio; // (only for CPU)
+  bool numa; // (only for CPU)
+  bool deterministic; // (only for CPU)
+  bool adaptive_eps; // (only for CPU)
+  bool bound_ordered_eps; // (only for CPU)
+  bool eps_frontier; // (only for CPU)
+  size_t interleave; // (only for CPU)
+  RestartStrategy restart; // (only for CPU)
+  size_t restart_base; // (only for CPU)
+  bool nogoods; // (only for CPU)
+  bool learning; // (only for CPU)
+  VarOrder var_order; // (only for CPU)
+  bool solution_guided; // (only for CPU)
+  size_t lns; // (only for CPU)
+  size_t dichotomic; // (only for CPU)
+  size_t coordinator_port; // (only for CPU)
   Arch arch;
   battery::string<allocator_type> problem_path;
   battery::string<allocator_type> version;
   battery::string<allocator_type> hardware;
+  battery::string<allocator_type> connect_to; // (only for CPU)
 
   CUDA Configuration(const allocator_type& alloc = allocator_type{}):
     print_intermediate_solutions(false),
@@ -57,10 +114,28 @@ struct Configuration {
     only_global_memory(false),
     noatomics(false),
     timeout_ms(0),
-    and_nodes(0),
     or_nodes(0),
+    auto_threads(false),
+    and_nodes(0),
     subproblems_power(SUBPROBLEMS_POWER),
     stack_kb(STACK_KB),
+    work_stealing(false),
+    portfolio(0),
+    numa(false),
+    deterministic(false),
+    adaptive_eps(false),
+    bound_ordered_eps(false),
+    eps_frontier(false),
+    interleave(0),
+    restart(RestartStrategy::NONE),
+    restart_base(RESTART_BASE),
+    nogoods(false),
+    learning(false),
+    var_order(VarOrder::SPLIT),
+    solution_guided(false),
+    lns(0),
+    dichotomic(0),
+    coordinator_port(0),
     arch(
       #ifdef __CUDACC__
         Arch::GPU
@@ -70,7 +145,8 @@ struct Configuration {
     ),
     problem_path(alloc),
     version(alloc),
-    hardware(alloc)
+    hardware(alloc),
+    connect_to(alloc)
   {}
 
   Configuration(Configuration<allocator_type>&&) = default;
@@ -89,13 +165,32 @@ struct Configuration {
     noatomics(other.noatomics),
     timeout_ms(other.timeout_ms),
     or_nodes(other.or_nodes),
+    auto_threads(other.auto_threads),
     and_nodes(other.and_nodes),
     subproblems_power(other.subproblems_power),
     stack_kb(other.stack_kb),
+    work_stealing(other.work_stealing),
+    portfolio(other.portfolio),
+    numa(other.numa),
+    deterministic(other.deterministic),
+    adaptive_eps(other.adaptive_eps),
+    bound_ordered_eps(other.bound_ordered_eps),
+    eps_frontier(other.eps_frontier),
+    interleave(other.interleave),
+    restart(other.restart),
+    restart_base(other.restart_base),
+    nogoods(other.nogoods),
+    learning(other.learning),
+    var_order(other.var_order),
+    solution_guided(other.solution_guided),
+    lns(other.lns),
+    dichotomic(other.dichotomic),
+    coordinator_port(other.coordinator_port),
     arch(other.arch),
     problem_path(other.problem_path, alloc),
     version(other.version, alloc),
-    hardware(other.hardware, alloc)
+    hardware(other.hardware, alloc),
+    connect_to(other.connect_to, alloc)
   {}
 
   template <class Alloc2>
@@ -112,12 +207,47 @@ struct Configuration {
     timeout_ms = other.timeout_ms;
     and_nodes = other.and_nodes;
     or_nodes = other.or_nodes;
+    auto_threads = other.auto_threads;
     subproblems_power = other.subproblems_power;
     stack_kb = other.stack_kb;
+    work_stealing = other.work_stealing;
+    portfolio = other.portfolio;
+    numa = other.numa;
+    deterministic = other.deterministic;
+    adaptive_eps = other.adaptive_eps;
+    bound_ordered_eps = other.bound_ordered_eps;
+    eps_frontier = other.eps_frontier;
+    interleave = other.interleave;
+    restart = other.restart;
+    restart_base = other.restart_base;
+    nogoods = other.nogoods;
+    learning = other.learning;
+    var_order = other.var_order;
+    solution_guided = other.solution_guided;
+    lns = other.lns;
+    dichotomic = other.dichotomic;
+    coordinator_port = other.coordinator_port;
     arch = other.arch;
     problem_path = other.problem_path;
     version = other.version;
     hardware = other.hardware;
+    connect_to = other.connect_to;
+  }
+
+  CUDA const char* restart_name() const {
+    switch(restart) {
+      case RestartStrategy::LUBY: return "luby";
+      case RestartStrategy::GEOMETRIC: return "geometric";
+      default: return "none";
+    }
+  }
+
+  CUDA const char* var_order_name() const {
+    switch(var_order) {
+      case VarOrder::DOM_WDEG: return "dom_w_deg";
+      case VarOrder::ACTIVITY: return "activity";
+      default: return "split";
+    }
   }
 
   CUDA void print_commandline(const char* program_name) {
@@ -139,7 +269,38 @@ struct Configuration {
         (noatomics ? "-noatomics " : ""));
     }
     else {
-      printf("-arch cpu -p %" PRIu64 " ", or_nodes);
+      printf("-arch cpu -p %" PRIu64 " -and %" PRIu64 " -sub %" PRIu64 " ", or_nodes, and_nodes, subproblems_power);
+      printf("%s%s%s%s%s%s", (work_stealing ? "-ws " : ""), (numa ? "-numa " : ""), (deterministic ? "-deterministic " : ""), (adaptive_eps ? "-adaptive " : ""), (bound_ordered_eps ? "-bound-order " : ""), (eps_frontier ? "-frontier " : ""));
+      if(interleave != 0) {
+        printf("-interleave %" PRIu64 " ", interleave);
+      }
+      if(portfolio != 0) {
+        printf("-portfolio %" PRIu64 " ", portfolio);
+      }
+      if(restart != RestartStrategy::NONE) {
+        printf("-restart %s -restart-base %" PRIu64 " %s", restart_name(), restart_base, (nogoods ? "-nogoods " : ""));
+      }
+      if(learning) {
+        printf("-learn ");
+      }
+      if(var_order != VarOrder::SPLIT) {
+        printf("-var-order %s ", var_order_name());
+      }
+      if(solution_guided) {
+        printf("-solution-guided ");
+      }
+      if(lns != 0) {
+        printf("-lns %" PRIu64 " ", lns);
+      }
+      if(dichotomic != 0) {
+        printf("-dichotomic %" PRIu64 " ", dichotomic);
+      }
+      if(coordinator_port != 0) {
+        printf("-coordinator %" PRIu64 " ", coordinator_port);
+      }
+      if(connect_to.size() != 0) {
+        printf("-connect %s ", connect_to.data());
+      }
     }
     if(version.size() != 0) {
       printf("-version %s ", version.data());
@@ -163,6 +324,66 @@ struct Configuration {
     printf("%%%%%%mzn-stat: free_search=\"%s\"\n", free_search ? "yes" : "no");
     printf("%%%%%%mzn-stat: or_nodes=%" PRIu64 "\n", or_nodes);
     printf("%%%%%%mzn-stat: timeout_ms=%" PRIu64 "\n", timeout_ms);
+    printf("%%%%%%mzn-stat: subproblems_power=%" PRIu64 "\n", subproblems_power);
+    if(arch == Arch::CPU) {
+      printf("%%%%%%mzn-stat: and_nodes=%" PRIu64 "\n", and_nodes);
+      // The options of the CPU modes are only printed when the mode is enabled.
+      if(auto_threads) {
+        printf("%%%%%%mzn-stat: auto_threads=\"yes\"\n");
+      }
+      if(work_stealing) {
+        printf("%%%%%%mzn-stat: work_stealing=\"yes\"\n");
+      }
+      if(portfolio != 0) {
+        printf("%%%%%%mzn-stat: portfolio=%" PRIu64 "\n", portfolio);
+      }
+      if(numa) {
+        printf("%%%%%%mzn-stat: numa=\"yes\"\n");
+      }
+      if(deterministic) {
+        printf("%%%%%%mzn-stat: deterministic=\"yes\"\n");
+      }
+      if(adaptive_eps) {
+        printf("%%%%%%mzn-stat: adaptive_eps=\"yes\"\n");
+      }
+      if(bound_ordered_eps) {
+        printf("%%%%%%mzn-stat: bound_ordered_eps=\"yes\"\n");
+      }
+      if(eps_frontier) {
+        printf("%%%%%%mzn-stat: eps_frontier=\"yes\"\n");
+      }
+      if(interleave != 0) {
+        printf("%%%%%%mzn-stat: interleave=%" PRIu64 "\n", interleave);
+      }
+      if(restart != RestartStrategy::NONE) {
+        printf("%%%%%%mzn-stat: restart=\"%s\"\n", restart_name());
+        printf("%%%%%%mzn-stat: restart_base=%" PRIu64 "\n", restart_base);
+      }
+      if(nogoods) {
+        printf("%%%%%%mzn-stat: nogoods=\"yes\"\n");
+      }
+      if(learning) {
+        printf("%%%%%%mzn-stat: learning=\"yes\"\n");
+      }
+      if(var_order != VarOrder::SPLIT) {
+        printf("%%%%%%mzn-stat: var_order=\"%s\"\n", var_order_name());
+      }
+      if(solution_guided) {
+        printf("%%%%%%mzn-stat: solution_guided=\"yes\"\n");
+      }
+      if(lns != 0) {
+        printf("%%%%%%mzn-stat: lns=%" PRIu64 "\n", lns);
+      }
+      if(dichotomic != 0) {
+        printf("%%%%%%mzn-stat: dichotomic=%" PRIu64 "\n", dichotomic);
+      }
+      if(coordinator_port != 0) {
+        printf("%%%%%%mzn-stat: coordinator_port=%" PRIu64 "\n", coordinator_port);
+      }
+      if(connect_to.size() != 0) {
+        printf("%%%%%%mzn-stat: connect_to=\"%s\"\n", connect_to.data());
+      }
+    }
     if(arch == Arch::GPU) {
       printf("%%%%%%mzn-stat: and_nodes=%" PRIu64 "\n", and_nodes);
       printf("%%%%%%mzn-stat: stack_size=%" PRIu64 "\n", stack_kb * 1000);
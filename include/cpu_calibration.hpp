@@ -0,0 +1,154 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_CPU_CALIBRATION_HPP
+#define TURBO_CPU_CALIBRATION_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+  #include <sched.h>
+#endif
+
+#include "common_solving.hpp"
+
+/** The number of cores this process can use: the CPUs of its affinity mask, limited by the CPU quota of its cgroup (e.g. in a container or a Slurm job). */
+inline size_t available_cores() {
+  size_t cores = std::max(1u, std::thread::hardware_concurrency());
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if(sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0) {
+    cores = std::max(1, CPU_COUNT(&cpuset));
+  }
+  double quota = -1;
+  double period = -1;
+  // cgroup v2: "<quota> <period>" or "max <period>".
+  std::ifstream cpu_max("/sys/fs/cgroup/cpu.max");
+  std::string quota_v2;
+  if(cpu_max >> quota_v2 >> period && quota_v2 != "max") {
+    quota = std::stod(quota_v2);
+  }
+  else {
+    // cgroup v1, the quota is -1 if there is no limit.
+    std::ifstream quota_v1("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+    std::ifstream period_v1("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    if(!(quota_v1 >> quota && period_v1 >> period)) {
+      quota = -1;
+    }
+  }
+  if(quota > 0 && period > 0) {
+    cores = std::min(cores, static_cast<size_t>(std::max(1.0, std::ceil(quota / period))));
+  }
+#endif
+  return cores;
+}
+
+inline size_t ceil_log2(size_t n) {
+  size_t p = 0;
+  while((size_t{1} << p) < n) {
+    ++p;
+  }
+  return p;
+}
+
+/** The measures of the calibration run by `-p 0`, and the number of threads and the EPS depth chosen from them. */
+struct ThreadCalibration {
+  size_t available_cores;
+  double copy_ms;
+  double root_fixpoint_ms;
+  double node_ms;
+  size_t sample_dives;
+  size_t sample_nodes;
+  // Number of sample dives ending on a leaf node (failed or solution) before `AUTO_CALIBRATION_MAX_DEPTH`, and the deepest of these leaves.
+  size_t leaf_dives;
+  size_t max_leaf_depth;
+  size_t threads;
+  size_t subproblems_power;
+
+  void print_mzn_statistics() const {
+    printf("%%%%%%mzn-stat: auto_available_cores=%zu\n", available_cores);
+    printf("%%%%%%mzn-stat: auto_copy_ms=%lf\n", copy_ms);
+    printf("%%%%%%mzn-stat: auto_root_fixpoint_ms=%lf\n", root_fixpoint_ms);
+    printf("%%%%%%mzn-stat: auto_node_ms=%lf\n", node_ms);
+    printf("%%%%%%mzn-stat: auto_sample_dives=%zu\n", sample_dives);
+    printf("%%%%%%mzn-stat: auto_sample_nodes=%zu\n", sample_nodes);
+    printf("%%%%%%mzn-stat: auto_leaf_dives=%zu\n", leaf_dives);
+    printf("%%%%%%mzn-stat: auto_threads=%zu\n", threads);
+    printf("%%%%%%mzn-stat: auto_subproblems_power=%zu\n", subproblems_power);
+  }
+};
+
+inline size_t calibrated_subproblems_power(size_t threads) {
+  return std::max<size_t>(1, ceil_log2(threads * AUTO_SUBPROBLEMS_PER_THREAD));
+}
+
+/** The time spent by `threads` threads on the work that the sequential search does not do: each thread copies the problem (`copy_ms`), and the dive to each subproblem propagates again `subproblems_power` nodes (`node_ms` each).
+ * The dives dominate when the propagation is expensive compared to the copy, hence the number of threads cannot only be chosen from the copy time. */
+inline double parallel_overhead_ms(const ThreadCalibration& c, size_t threads) {
+  size_t subproblems = size_t{1} << calibrated_subproblems_power(threads);
+  return threads * c.copy_ms + subproblems * calibrated_subproblems_power(threads) * c.node_ms;
+}
+
+/** Measure the cost of the problem `root` after `preprocess` (copy, root fixpoint and random dives on the EPS strategy), and choose the number of threads and the EPS depth:
+ *  - One thread if all the dives reach a leaf before the depth needed to give two subproblems to each core, because the search tree is too small to be shared.
+ *  - Otherwise one thread per available core, but the overhead of the parallel search must not take more than `AUTO_MAX_OVERHEAD_RATIO` of the timeout (see `parallel_overhead_ms`).
+ *  - `AUTO_SUBPROBLEMS_PER_THREAD` subproblems per thread, as usually recommended for EPS.
+ * The calibration stops after `AUTO_CALIBRATION_MS` milliseconds even if all the dives are not done, and is not counted in the statistics of `root`.
+ */
+template <class A>
+ThreadCalibration calibrate_cpu_threads(const A& root) {
+  using clock = std::chrono::high_resolution_clock;
+  using ms = std::chrono::duration<double, std::milli>;
+  ThreadCalibration c{};
+  c.available_cores = available_cores();
+  auto start = clock::now();
+  A probe(root);
+  c.copy_ms = ms(clock::now() - start).count();
+  GaussSeidelIteration fp_engine;
+  auto fixpoint_start = clock::now();
+  fp_engine.fixpoint(*probe.ipc);
+  c.root_fixpoint_ms = ms(clock::now() - fixpoint_start).count();
+  auto snapshot = probe.search_tree->template snapshot<battery::standard_allocator>();
+  std::mt19937 rng(0);
+  auto dives_start = clock::now();
+  double dives_ms = 0;
+  while(c.sample_dives < AUTO_CALIBRATION_DIVES && (dives_ms = ms(clock::now() - dives_start).count()) < AUTO_CALIBRATION_MS) {
+    probe.search_tree->restore(snapshot);
+    probe.eps_split->reset();
+    c.sample_dives++;
+    for(size_t depth = 0; depth < AUTO_CALIBRATION_MAX_DEPTH; ++depth) {
+      fp_engine.fixpoint(*probe.ipc);
+      c.sample_nodes++;
+      if(probe.ipc->is_top() || probe.search_tree->template is_extractable<AtomicExtraction>()) {
+        c.leaf_dives++;
+        c.max_leaf_depth = std::max(c.max_leaf_depth, depth);
+        break;
+      }
+      auto branches = probe.eps_split->split();
+      if(branches.size() != 2) {
+        break;
+      }
+      probe.ipc->tell(branches[rng() % 2]);
+    }
+  }
+  c.node_ms = c.sample_nodes == 0 ? 0 : dives_ms / c.sample_nodes;
+  c.threads = c.available_cores;
+  if(c.leaf_dives == c.sample_dives && c.max_leaf_depth < ceil_log2(c.threads) + 1) {
+    c.threads = 1;
+  }
+  if(root.config.timeout_ms != 0) {
+    while(c.threads > 1 && parallel_overhead_ms(c, c.threads) > AUTO_MAX_OVERHEAD_RATIO * root.config.timeout_ms) {
+      c.threads--;
+    }
+  }
+  c.subproblems_power = calibrated_subproblems_power(c.threads);
+  return c;
+}
+
+#endif
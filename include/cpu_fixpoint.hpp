@@ -0,0 +1,120 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_CPU_FIXPOINT_HPP
+#define TURBO_CPU_FIXPOINT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <thread>
+#include <vector>
+
+#include "common_solving.hpp"
+
+/** `AsynchronousIterationCPU` is the CPU counterpart of `BlockAsynchronousIterationGPU`.
+ * The propagators are distributed among `num_threads` threads (the calling thread and `num_threads - 1` helper threads created once in the constructor), each thread refining the propagators `i`, `i + num_threads`, ...
+ * The threads iterate over their propagators until none of them changes the store during an iteration.
+ * Since the threads refine the store concurrently, it must be in atomic memory (e.g. `CP<AtomicItv>`).
+ */
+class AsynchronousIterationCPU {
+  using job_type = void(*)(void*, size_t, size_t, local::BInc&);
+
+  size_t num_threads;
+  std::vector<std::thread> helpers;
+  std::barrier<> start_iteration;
+  std::barrier<> end_iteration;
+  job_type job;
+  void* job_data;
+  std::atomic<bool> changed;
+  bool terminate;
+
+  template <class A>
+  static void iterate_job(void* data, size_t tid, size_t n, local::BInc& has_changed) {
+    A& a = *static_cast<A*>(data);
+    size_t num_refinements = a.num_refinements();
+    for(size_t i = tid; i < num_refinements; i += n) {
+      a.refine(i, has_changed);
+    }
+  }
+
+  /** Run the job of thread `tid` once, the writes to `job`, `job_data` and `terminate` are visible thanks to the barriers. */
+  void iterate(size_t tid) {
+    local::BInc has_changed;
+    job(job_data, tid, num_threads, has_changed);
+    if(has_changed) {
+      changed.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  void helper(size_t tid) {
+    while(true) {
+      start_iteration.arrive_and_wait();
+      if(terminate) {
+        return;
+      }
+      iterate(tid);
+      end_iteration.arrive_and_wait();
+    }
+  }
+
+public:
+  AsynchronousIterationCPU(size_t num_threads)
+    : num_threads(num_threads)
+    , start_iteration(num_threads)
+    , end_iteration(num_threads)
+    , job(nullptr)
+    , job_data(nullptr)
+    , changed(false)
+    , terminate(false)
+  {
+    for(size_t i = 1; i < num_threads; ++i) {
+      helpers.emplace_back(&AsynchronousIterationCPU::helper, this, i);
+    }
+  }
+
+  AsynchronousIterationCPU(const AsynchronousIterationCPU&) = delete;
+
+  ~AsynchronousIterationCPU() {
+    terminate = true;
+    start_iteration.arrive_and_wait();
+    for(auto& t : helpers) {
+      t.join();
+    }
+  }
+
+  /** Compute the fixpoint of `a` and returns the number of iterations.
+   * As on GPU, the iterations also stop when `*stop` becomes `true` (if `stop` is not `nullptr`). */
+  template <class A, class M>
+  size_t fixpoint(A& a, BInc<M>& has_changed, const std::atomic<bool>* stop) {
+    job = iterate_job<A>;
+    job_data = &a;
+    size_t iterations = 0;
+    bool iteration_changed = true;
+    while(iteration_changed && !a.is_top() && (stop == nullptr || !*stop)) {
+      changed.store(false, std::memory_order_relaxed);
+      start_iteration.arrive_and_wait();
+      iterate(0);
+      end_iteration.arrive_and_wait();
+      iteration_changed = changed.load(std::memory_order_relaxed);
+      has_changed.tell(local::BInc(iteration_changed));
+      iterations++;
+    }
+    return iterations;
+  }
+
+  template <class A, class M>
+  size_t fixpoint(A& a, BInc<M>& has_changed) {
+    return fixpoint(a, has_changed, nullptr);
+  }
+
+  template <class A>
+  size_t fixpoint(A& a) {
+    local::BInc has_changed;
+    return fixpoint(a, has_changed);
+  }
+
+  /** The helper threads only run during `fixpoint`, hence the calling thread never needs to wait for them outside of it (unlike the threads of a block on GPU). */
+  void barrier() {}
+};
+
+#endif
@@ -0,0 +1,241 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_CPU_PARALLEL_HPP
+#define TURBO_CPU_PARALLEL_HPP
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "common_solving.hpp"
+#include "numa.hpp"
+
+namespace bt = ::battery;
+
+/** Atomically replace `a` by `max(a, b)`, it is the CPU counterpart of `ZInc<size_t, atomic_memory_grid>::tell`. */
+inline void atomic_max(std::atomic<size_t>& a, size_t b) {
+  size_t current = a.load();
+  while(current < b && !a.compare_exchange_weak(current, b)) {}
+}
+
+/** The objective value of the best solution found so far by any thread, shared without locks.
+ * A thread publishes its bound as soon as it finds a better solution, before the full solution is extracted in `root` under `print_lock`.
+ */
+struct SharedIncumbent {
+  bool minimize;
+  std::atomic<int> value;
+
+  SharedIncumbent(bool minimize)
+    : minimize(minimize)
+    , value(no_value())
+  {}
+
+  int no_value() const {
+    return minimize ? std::numeric_limits<int>::max() : std::numeric_limits<int>::min();
+  }
+
+  bool is_better(int a, int b) const {
+    return minimize ? a < b : a > b;
+  }
+
+  /** \return `true` if `v` is better than the current value, which is then replaced by `v`. */
+  bool improve(int v) {
+    int current = value.load(std::memory_order_relaxed);
+    while(is_better(v, current)) {
+      if(value.compare_exchange_weak(current, v, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** The value of the objective `x` in the solution `sol`. */
+  template <class Store>
+  int value_of(const Store& sol, AVar x) const {
+    auto obj = sol.project(x);
+    return minimize ? obj.lb().value() : obj.ub().value();
+  }
+
+  /** Tell in `store` that the objective `x` must be strictly better than the current value.
+   * This is a direct update of the domain of `x`, without interpreting any formula.
+   */
+  template <class Store>
+  void tell(Store& store, AVar x) const {
+    int v = value.load(std::memory_order_relaxed);
+    if(v == no_value()) {
+      return;
+    }
+    if(minimize) {
+      store.tell(x, Itv(Itv::LB::bot(), Itv::UB(v - 1)));
+    }
+    else {
+      store.tell(x, Itv(Itv::LB(v + 1), Itv::UB::bot()));
+    }
+  }
+};
+
+/** `ParallelData` is the CPU counterpart of `GridData`, it is shared among all the threads of a CPU search engine.
+ * It represents the problem to be solved (`root`), the data of each thread (`workers`), the index of the subproblem that needs to be solved next (`next_subproblem`, only used by EPS) and the best bound found so far in case of optimisation problem (`incumbent`).
+ * The solutions are directly extracted in `root` when found, and printed under the lock `print_lock`.
+ *
+ * A `Worker` must provide a constructor `Worker(size_t idx, const CP<Itv>& root)`, a member `cp` pointing to its copy of the problem (created with `make_worker_cp`), a fixpoint engine `fp_engine` and a function `depth()` returning the depth of the current node.
+ */
+template <class Worker>
+struct ParallelData {
+  CP<Itv>& root;
+  // A deque does not require `Worker` to be movable (it usually contains mutexes).
+  std::deque<Worker> workers;
+  // Stop the search, because of a timeout, CTRL-C or because we found enough solutions.
+  std::atomic<bool> stop;
+  std::atomic<size_t> next_subproblem;
+  // Number of threads which terminated their search (they might not have explored all their subproblems if `stop` is true).
+  std::atomic<size_t> workers_done;
+  // Protect `root` and the standard output.
+  std::mutex print_lock;
+  SharedIncumbent incumbent;
+  // The statistics of each worker, readable while solving.
+  StatisticsRegistry<bt::standard_allocator> live_stats;
+  // Called under `print_lock` each time a new solution is extracted in `root`.
+  std::function<void()> on_new_solution;
+
+  ParallelData(CP<Itv>& root, size_t num_workers)
+    : root(root)
+    , stop(false)
+    , next_subproblem(num_workers)
+    , workers_done(0)
+    , incumbent(root.bab->is_minimization())
+    , live_stats(num_workers)
+  {
+    for(size_t i = 0; i < num_workers; ++i) {
+      workers.emplace_back(i, root);
+      workers.back().cp->live = live_stats.slot(i);
+    }
+  }
+
+  /** Called when a worker found a solution, already extracted in `cp.best`.
+   * The solution is kept only if it is better than the best one found so far by any worker.
+   * \return `false` if the search must stop, for instance because we found enough solutions.
+   */
+  template <class WorkerCP>
+  bool on_solution_node(WorkerCP& cp) {
+    if(cp.bab->is_optimization() && !incumbent.improve(incumbent.value_of(*cp.best, cp.bab->objective_var()))) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(print_lock);
+    if(stop) {
+      return false;
+    }
+    // Another thread might have extracted a better solution between `improve` and the lock.
+    if(cp.bab->is_optimization() && !root.best->is_bot() && !cp.bab->compare_bound(*cp.best, *root.best)) {
+      return true;
+    }
+    cp.bab->extract(*root.bab);
+    if(on_new_solution) {
+      on_new_solution();
+    }
+    return root.on_solution_node();
+  }
+};
+
+/** The best bound found across threads is directly told in the store of the worker.
+ * It must be called in each node since the bound is erased on backtracking.
+ * Contrarily to `update_block_best_bound` on GPU, it does not allocate anything.
+ */
+template <class Worker>
+void update_worker_best_bound(Worker& w, ParallelData<Worker>& data) {
+  auto& cp = *w.cp;
+  if(cp.bab->is_optimization()) {
+    data.incumbent.tell(*cp.store, cp.bab->objective_var());
+  }
+}
+
+/** Propagate a node of the search tree and process the leaf nodes (failed or solution).
+ * The solutions are extracted in `cp.best` and then given to `on_solution(cp)`.
+ * Branching on unknown nodes is a task left to the caller.
+ */
+template <class Worker, class OnSolution>
+bool propagate(Worker& w, ParallelData<Worker>& data, local::BInc& has_changed, OnSolution on_solution) {
+  bool is_leaf_node = false;
+  auto& cp = *w.cp;
+  cp.stats.fixpoint_iterations += w.fp_engine.fixpoint(*cp.ipc, has_changed);
+  cp.on_node(w.depth());
+  if(cp.ipc->is_top()) {
+    is_leaf_node = true;
+    cp.on_failed_node();
+  }
+  else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
+    is_leaf_node = true;
+    if(cp.bab->is_satisfaction() || cp.bab->compare_bound(*cp.store, cp.bab->optimum())) {
+      cp.bab->refine(has_changed);
+      on_solution(cp);
+    }
+  }
+#ifdef TURBO_PROFILE_MODE
+  if(cp.stats.nodes >= cp.config.stop_after_n_nodes) {
+    data.stop = true;
+  }
+#endif
+  return is_leaf_node;
+}
+
+/** Same as above, but the solutions are directly shared with the other workers. */
+template <class Worker>
+bool propagate(Worker& w, ParallelData<Worker>& data, local::BInc& has_changed) {
+  return propagate(w, data, has_changed, [&](auto& cp) {
+    if(!data.on_solution_node(cp)) {
+      data.stop = true;
+    }
+  });
+}
+
+/** Run `worker_fn(data, i)` on one thread per worker, until all of them terminate, or until the timeout or CTRL-C.
+ * With `config.numa`, the thread `i` is pinned to the CPU of the worker `i` (see `NumaTopology`).
+ * In verbose mode, the statistics of the workers are printed every `LIVE_STATISTICS_PERIOD_MS` milliseconds.
+ * The statistics and best solutions of the workers are then reduced in `data.root`.
+ */
+template <class Worker, class F, class Timepoint>
+void run_parallel(ParallelData<Worker>& data, F worker_fn, const Timepoint& start) {
+  CP<Itv>& root = data.root;
+  size_t num_workers = data.workers.size();
+  if(root.config.numa && root.config.verbose_solving) {
+    printf("%% NUMA: %zu nodes detected, the threads are pinned to their cores.\n", NumaTopology::get().num_nodes());
+#ifndef TURBO_NUMA
+    printf("%% WARNING: Turbo was compiled without libnuma (WITH_NUMA=OFF), the memory is not placed on the NUMA nodes.\n");
+#endif
+  }
+  std::vector<std::thread> threads;
+  for(size_t i = 0; i < num_workers; ++i) {
+    threads.emplace_back([&data, worker_fn, i]() {
+      if(data.root.config.numa && !NumaTopology::get().pin_worker(i) && data.root.config.verbose_solving) {
+        std::lock_guard<std::mutex> lock(data.print_lock);
+        printf("%% WARNING: Thread %zu could not be pinned to CPU %d.\n", i, NumaTopology::get().cpu_of_worker(i));
+      }
+      worker_fn(data, i);
+      data.workers_done += 1;
+    });
+  }
+  int64_t next_live_print = LIVE_STATISTICS_PERIOD_MS;
+  while(!must_quit() && check_timeout(root, start) && data.workers_done < num_workers) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if(root.config.verbose_solving && root.stats.duration >= next_live_print) {
+      std::lock_guard<std::mutex> lock(data.print_lock);
+      data.live_stats.print(root.stats.duration);
+      next_live_print += LIVE_STATISTICS_PERIOD_MS;
+    }
+  }
+  if(data.workers_done < num_workers) {
+    data.stop = true;
+    root.stats.exhaustive = false;
+  }
+  for(auto& t : threads) {
+    t.join();
+  }
+  for(auto& w : data.workers) {
+    root.join(*w.cp);
+  }
+}
+
+#endif
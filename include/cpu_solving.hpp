@@ -3,31 +3,1548 @@
 #ifndef TURBO_CPU_SOLVING_HPP
 #define TURBO_CPU_SOLVING_HPP
 
+#include <algorithm>
+#include <barrier>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
 #include "common_solving.hpp"
+#include "cpu_calibration.hpp"
+#include "cpu_fixpoint.hpp"
+#include "cpu_parallel.hpp"
+#include "eps_granularity.hpp"
+#include "work_stealing_solving.hpp"
+#include "portfolio_solving.hpp"
+#include "branching.hpp"
+#include "nogoods.hpp"
+#include "restart.hpp"
+#include "distributed_solving.hpp"
 
-void cpu_solve(const Configuration<battery::standard_allocator>& config) {
-  auto start = std::chrono::high_resolution_clock::now();
+template <class A, class FPEngine, class Timepoint>
+void cpu_sequential_search(A& cp, FPEngine& fp_engine, const Timepoint& start) {
+  local::BInc has_changed = true;
+  while(!must_quit() && check_timeout(cp, start) && has_changed) {
+    has_changed = false;
+    cp.stats.fixpoint_iterations += fp_engine.fixpoint(*cp.ipc, has_changed);
+    cp.on_node();
+    if(cp.ipc->is_top()) {
+      cp.on_failed_node();
+    }
+    else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
+      cp.bab->refine(has_changed);
+      if(!cp.on_solution_node()) {
+        break;
+      }
+    }
+    cp.search_tree->refine(has_changed);
+  }
+}
 
-  CP<Itv> cp(config);
-  cp.preprocess();
+enum class RunOutcome {
+  EXHAUSTED, // The search tree has been fully explored.
+  FAIL_LIMIT,
+  SOLUTION, // Only when `stop_on_solution` is set.
+  STOPPED // Timeout, CTRL-C or enough solutions found.
+};
 
-  GaussSeidelIteration fp_engine;
+/** Depth-first search from the current node of `cp.search_tree` until `cp.stats.fails` reaches `fails_limit`.
+ * The bound of the best solution (`incumbent`) and the constraints added by `on_node(cp)` are told in each node, since they are erased by `search_tree->restore`.
+ */
+template <class A, class FPEngine, class Timepoint, class OnNode>
+RunOutcome cpu_limited_search(A& cp, FPEngine& fp_engine, const Timepoint& start, SharedIncumbent& incumbent, size_t fails_limit, bool stop_on_solution, OnNode on_node) {
   local::BInc has_changed = true;
-  block_signal_ctrlc();
-  while(!must_quit() && check_timeout(cp, start) && has_changed) {
+  while(has_changed) {
+    if(must_quit() || !check_timeout(cp, start)) {
+      return RunOutcome::STOPPED;
+    }
     has_changed = false;
+    if(cp.bab->is_optimization()) {
+      incumbent.tell(*cp.store, cp.bab->objective_var());
+    }
+    on_node(cp);
     cp.stats.fixpoint_iterations += fp_engine.fixpoint(*cp.ipc, has_changed);
     cp.on_node();
+    bool new_solution = false;
     if(cp.ipc->is_top()) {
       cp.on_failed_node();
     }
     else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
+      cp.bab->refine(has_changed);
+      if(!cp.on_solution_node()) {
+        return RunOutcome::STOPPED;
+      }
+      if(cp.bab->is_optimization()) {
+        incumbent.improve(incumbent.value_of(*cp.best, cp.bab->objective_var()));
+      }
+      new_solution = true;
+    }
+    cp.search_tree->refine(has_changed);
+    if(new_solution && stop_on_solution) {
+      return RunOutcome::SOLUTION;
+    }
+    if(has_changed && cp.stats.fails >= fails_limit) {
+      return RunOutcome::FAIL_LIMIT;
+    }
+  }
+  return RunOutcome::EXHAUSTED;
+}
+
+/** Same as `cpu_sequential_search`, but the search restarts from the root each time the number of failures since the last restart reaches the limit given by `config.restart`.
+ * The best solution is kept across restarts.
+ * Only the search tree is restored, hence the state of the search strategies (if any) is kept from one run to the next.
+ * The search is complete: it stops when a run explores its whole search tree.
+ * The split strategy of the model is static, hence the runs explore the same prefix of the search tree, unless a better solution prunes it.
+ */
+template <class A, class FPEngine, class Timepoint>
+void cpu_restart_search(A& cp, FPEngine& fp_engine, const Timepoint& start) {
+  auto root = cp.search_tree->template snapshot<bt::standard_allocator>();
+  RestartSchedule schedule(cp.config.restart, cp.config.restart_base);
+  SharedIncumbent incumbent(cp.bab->is_minimization());
+  auto no_constraint = [](A&) {};
+  while(cpu_limited_search(cp, fp_engine, start, incumbent, cp.stats.fails + schedule.next_limit(), false, no_constraint) == RunOutcome::FAIL_LIMIT) {
+    cp.search_tree->restore(root);
+    cp.stats.restarts++;
+  }
+}
+
+/** Propagate the node with the propagators of `ipc` and the nogoods, until none of them changes the store.
+ * \return The number of bounds told by the nogoods. */
+template <class A, class FPEngine>
+size_t propagate_with_nogoods(A& cp, FPEngine& fp_engine, NogoodDatabase& nogoods) {
+  size_t num_tells = 1;
+  size_t total_tells = 0;
+  while(num_tells > 0 && !cp.ipc->is_top()) {
+    cp.stats.fixpoint_iterations += fp_engine.fixpoint(*cp.ipc);
+    num_tells = cp.ipc->is_top() ? 0 : nogoods.propagate(*cp.store);
+    total_tells += num_tells;
+  }
+  return total_tells;
+}
+
+/** Enter the right branch of the decision `level`, the deeper decisions are forgotten.
+ * The split strategy is reset because the variables it already skipped might not be assigned anymore. */
+template <class A>
+void enter_right_branch(A& cp, std::vector<SearchDecision<A>>& decisions, size_t level) {
+  decisions.resize(level + 1);
+  decisions[level].on_right = true;
+  cp.ipc->restore(decisions[level].right);
+  cp.split->reset();
+}
+
+/** The deepest decision whose left branch is being explored, or `decisions.size()` if there is none (the search tree is exhausted). */
+template <class A>
+size_t deepest_left_decision(const std::vector<SearchDecision<A>>& decisions) {
+  for(size_t i = decisions.size(); i > 0; --i) {
+    if(!decisions[i - 1].on_right) {
+      return i - 1;
+    }
+  }
+  return decisions.size();
+}
+
+/** Depth-first search with a stack of the decisions taken, which are not visible in `search_tree` (as in the work-stealing engine), the decisions are created by `brancher` (see `branching.hpp`).
+ * With `config.restart`, the search restarts from the root as in `cpu_restart_search`.
+ * With `config.nogoods`, the refuted parts of the search tree are recorded as nogoods before each restart, so they are not explored again (nld-nogoods, see Lecoutre et al., "Recording and Minimizing Nogoods from Restarts", 2007).
+ * At a restart, each right branch of the stack gives the nogood made of the left decisions above it and of its own left decision, which has been refuted.
+ */
+template <class A, class FPEngine, class Brancher, class Timepoint>
+void cpu_decision_search(A& cp, FPEngine& fp_engine, Brancher& brancher, const Timepoint& start) {
+  auto root = cp.ipc->template snapshot<bt::standard_allocator>();
+  RestartSchedule schedule(cp.config.restart, cp.config.restart_base);
+  SharedIncumbent incumbent(cp.bab->is_minimization());
+  NogoodDatabase nogoods;
+  std::vector<SearchDecision<A>> decisions;
+  std::vector<BoundLiteral> nogood;
+  size_t fails_limit = cp.config.restart == RestartStrategy::NONE
+    ? std::numeric_limits<size_t>::max()
+    : cp.stats.fails + schedule.next_limit();
+  while(!must_quit() && check_timeout(cp, start)) {
+    if(cp.bab->is_optimization()) {
+      incumbent.tell(*cp.store, cp.bab->objective_var());
+    }
+    cp.stats.nogood_prunings += propagate_with_nogoods(cp, fp_engine, nogoods);
+    cp.on_node(decisions.size());
+    if(cp.ipc->is_top()) {
+      cp.on_failed_node();
+    }
+    else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
+      local::BInc has_changed;
+      cp.bab->refine(has_changed);
+      if(!cp.on_solution_node()) {
+        break;
+      }
+      if(cp.bab->is_optimization()) {
+        incumbent.improve(incumbent.value_of(*cp.best, cp.bab->objective_var()));
+      }
+    }
+    else if(brancher.branch(cp, decisions)) {
+      continue;
+    }
+    else {
+      cp.on_failed_node();
+    }
+    size_t level = deepest_left_decision(decisions);
+    if(level == decisions.size()) {
+      return;
+    }
+    enter_right_branch(cp, decisions, level);
+    if(cp.stats.fails >= fails_limit) {
+      nogood.clear();
+      for(const auto& d : decisions) {
+        size_t prefix = nogood.size();
+        nogood.insert(nogood.end(), d.left.begin(), d.left.end());
+        if(d.on_right && cp.config.nogoods) {
+          nogoods.add(nogood);
+          cp.stats.nogoods++;
+          nogood.resize(prefix);
+        }
+      }
+      decisions.clear();
+      cp.ipc->restore(root);
+      cp.split->reset();
+      cp.stats.restarts++;
+      fails_limit = cp.stats.fails + schedule.next_limit();
+    }
+  }
+  cp.stats.exhaustive = false;
+}
+
+/** Explain the failure of the current node by a subset of the left decisions of the branch, which is recorded as a nogood.
+ * The propagators of `ipc` do not give the reasons of their deductions, hence the explanation is computed by deletion: starting from the deepest one, a left decision is removed from the explanation if the other decisions still fail when propagated (with the nogoods and the bound of `incumbent`).
+ * When the decision `j` is tested, all the left decisions above it are still in the explanation, hence the test replays from `bases[j]`, the propagated node with only the left decisions above `j`, and only tells the deeper decisions of the explanation.
+ * `bases[i]` stays valid as long as the decision `i` is on the stack, so each base is computed once (by `extend_bases`) and reused by the next failures.
+ * The tests use their own `GaussSeidelIteration` engine, so they do not disturb the state of a fixpoint engine learning from the search (e.g. `DomWDegBrancher` or `ActivityBrancher`).
+ * The explanation is only searched when the branch has at most `LEARNING_MAX_DECISIONS` left decisions, and while the tests cost at most `LEARNING_CHECKS_PER_NODE` fixpoints per node explored.
+ * The right branches of the stack are not tested, since they are deduced by the nogoods from the left decisions above them.
+ * If they are not, for instance after a solution, the left decisions alone might not fail, and no nogood is learned.
+ * \return The deepest decision of the explanation, which can be refuted, or `decisions.size()` if the explanation is empty (the problem has no more solution), or the deepest left decision if no nogood is learned.
+ */
+template <class A, class Snapshot>
+size_t analyse_conflict(A& cp, const Snapshot& root, std::vector<Snapshot>& bases, const SharedIncumbent& incumbent,
+  NogoodDatabase& nogoods, const std::vector<SearchDecision<A>>& decisions, std::vector<size_t>& explanation, std::vector<BoundLiteral>& nogood)
+{
+  size_t chronological = deepest_left_decision(decisions);
+  if(chronological == decisions.size() || cp.stats.conflict_checks > LEARNING_CHECKS_PER_NODE * cp.stats.nodes) {
+    return chronological;
+  }
+  explanation.clear();
+  for(size_t i = 0; i < decisions.size(); ++i) {
+    if(!decisions[i].on_right) {
+      explanation.push_back(i);
+    }
+  }
+  if(explanation.size() > LEARNING_MAX_DECISIONS) {
+    return chronological;
+  }
+  GaussSeidelIteration fp_engine;
+  auto propagate = [&]() {
+    if(cp.bab->is_optimization()) {
+      incumbent.tell(*cp.store, cp.bab->objective_var());
+    }
+    propagate_with_nogoods(cp, fp_engine, nogoods);
+  };
+  // The decisions below `chronological` are on their right branch, and do not need a base.
+  if(bases.empty()) {
+    bases.push_back(root);
+  }
+  while(bases.size() <= chronological) {
+    size_t i = bases.size() - 1;
+    cp.ipc->restore(bases[i]);
+    if(!decisions[i].on_right) {
+      for(const auto& l : decisions[i].left) {
+        l.tell(*cp.store);
+      }
+    }
+    propagate();
+    bases.push_back(cp.ipc->template snapshot<bt::standard_allocator>());
+  }
+  // Whether the decisions of the explanation from `k` (excluded if `removed`) fail.
+  auto fails_from = [&](size_t k, bool removed) {
+    cp.ipc->restore(bases[explanation[k]]);
+    for(size_t e = removed ? k + 1 : k; e < explanation.size(); ++e) {
+      for(const auto& l : decisions[explanation[e]].left) {
+        l.tell(*cp.store);
+      }
+    }
+    propagate();
+    cp.stats.conflict_checks++;
+    return static_cast<bool>(cp.ipc->is_top());
+  };
+  if(!fails_from(explanation.size() - 1, false)) {
+    return chronological;
+  }
+  for(size_t k = explanation.size(); k > 0; --k) {
+    if(fails_from(k - 1, true)) {
+      explanation.erase(explanation.begin() + (k - 1));
+    }
+  }
+  if(explanation.empty()) {
+    return decisions.size();
+  }
+  nogood.clear();
+  for(size_t i : explanation) {
+    nogood.insert(nogood.end(), decisions[i].left.begin(), decisions[i].left.end());
+  }
+  nogoods.add(nogood);
+  cp.stats.learned_nogoods++;
+  return explanation.back();
+}
+
+/** Depth-first search learning a nogood from each failure (see `analyse_conflict`), and backjumping to the deepest decision of this nogood instead of the deepest left decision.
+ * This is not lazy clause generation: LCG records the reason of each deduction of the propagators and learns a clause over these deductions (1-UIP), but the propagators of `ipc` (defined in lala) only narrow the store and do not give their reasons.
+ * Instead, the nogoods only contain left decisions, minimised by deletion: they are minimal for the propagators of `ipc`, but weaker than the 1-UIP clauses, since they cannot mention the intermediate deductions.
+ * The deletion costs extra fixpoints, which are bounded: at most `LEARNING_MAX_DECISIONS + 1` per failure, and at most `LEARNING_CHECKS_PER_NODE` per node explored on average (counted in `conflict_checks`), hence the propagation is at most `LEARNING_CHECKS_PER_NODE + 1` times the one of the search without learning.
+ */
+template <class A, class FPEngine, class Brancher, class Timepoint>
+void cpu_learning_search(A& cp, FPEngine& fp_engine, Brancher& brancher, const Timepoint& start) {
+  using Snapshot = typename A::IPC::template snapshot_type<bt::standard_allocator>;
+  Snapshot root = cp.ipc->template snapshot<bt::standard_allocator>();
+  std::vector<Snapshot> bases;
+  SharedIncumbent incumbent(cp.bab->is_minimization());
+  NogoodDatabase nogoods;
+  std::vector<SearchDecision<A>> decisions;
+  std::vector<size_t> explanation;
+  std::vector<BoundLiteral> nogood;
+  while(!must_quit() && check_timeout(cp, start)) {
+    if(cp.bab->is_optimization()) {
+      incumbent.tell(*cp.store, cp.bab->objective_var());
+    }
+    cp.stats.nogood_prunings += propagate_with_nogoods(cp, fp_engine, nogoods);
+    cp.on_node(decisions.size());
+    size_t level;
+    if(cp.ipc->is_top()) {
+      cp.on_failed_node();
+      level = analyse_conflict(cp, root, bases, incumbent, nogoods, decisions, explanation, nogood);
+      size_t chronological = deepest_left_decision(decisions);
+      if(level < chronological) {
+        cp.stats.backjumped_levels += chronological - level;
+      }
+    }
+    else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
+      local::BInc has_changed;
       cp.bab->refine(has_changed);
       if(!cp.on_solution_node()) {
         break;
       }
+      if(cp.bab->is_optimization()) {
+        incumbent.improve(incumbent.value_of(*cp.best, cp.bab->objective_var()));
+      }
+      level = deepest_left_decision(decisions);
+    }
+    else if(brancher.branch(cp, decisions)) {
+      continue;
     }
+    else {
+      cp.on_failed_node();
+      level = deepest_left_decision(decisions);
+    }
+    if(level == decisions.size()) {
+      return;
+    }
+    enter_right_branch(cp, decisions, level);
+    bases.resize(std::min(bases.size(), level + 1));
+  }
+  cp.stats.exhaustive = false;
+}
+
+/** Large neighbourhood search (LNS) for optimisation problems.
+ * A complete search first looks for a solution.
+ * Then, each neighbourhood restores the root, fixes a subset of the decision variables (see `decision_variables`, the objective excepted) to their value in `cp.best` and searches the other variables for a better solution, until `config.lns` failures.
+ * The auxiliary variables are not fixed, since they are functionally defined by the decision variables, and fixing them would only make the neighbourhoods smaller.
+ * The subsets alternate between random variables and a window of consecutive variables (which are often related in the model, e.g. the tasks of a job).
+ * The ratio of relaxed (not fixed) variables grows when a neighbourhood is exhausted without improvement (too small), and shrinks when the failure limit is reached without improvement (too large).
+ * The neighbourhoods reuse `cp` and the root snapshot, and the fixings are stored in a vector allocated once.
+ * A neighbourhood fixing no variable is the whole problem, hence the optimality is proven if it is exhausted.
+ * Otherwise, the search only stops on the timeout or CTRL-C (or if the first complete search is exhausted), and the optimality is not proven.
+ */
+template <class A, class FPEngine, class Formula, class Timepoint>
+void cpu_lns_search(A& cp, FPEngine& fp_engine, const Formula& formula, const Timepoint& start) {
+  auto root = cp.search_tree->template snapshot<bt::standard_allocator>();
+  SharedIncumbent incumbent(cp.bab->is_minimization());
+  auto no_constraint = [](A&) {};
+  RunOutcome outcome = cpu_limited_search(cp, fp_engine, start, incumbent, std::numeric_limits<size_t>::max(), true, no_constraint);
+  if(outcome != RunOutcome::SOLUTION) {
+    return;
+  }
+  std::vector<int> vars = decision_variables(cp, *formula);
+  int objective = cp.bab->objective_var().vid();
+  vars.erase(std::remove(vars.begin(), vars.end(), objective), vars.end());
+  size_t n = vars.size();
+  std::vector<std::pair<int, int>> fixings;
+  fixings.reserve(n);
+  auto fix = [&](A& cp) {
+    for(const auto& [x, v] : fixings) {
+      cp.store->tell(x, Itv(Itv::LB(v), Itv::UB(v)));
+    }
+  };
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  double relax = LNS_INITIAL_RELAX;
+  while(outcome != RunOutcome::STOPPED) {
+    fixings.clear();
+    size_t window = static_cast<size_t>(relax * n);
+    size_t window_start = n == 0 ? 0 : rng() % n;
+    for(size_t i = 0; i < n; ++i) {
+      bool relaxed = (cp.stats.lns_neighbourhoods % 2 == 0)
+        ? coin(rng) < relax
+        : (i + n - window_start) % n < window;
+      if(!relaxed) {
+        fixings.emplace_back(vars[i], (*cp.best)[vars[i]].lb().value());
+      }
+    }
+    cp.search_tree->restore(root);
+    int before = incumbent.value.load();
+    outcome = cpu_limited_search(cp, fp_engine, start, incumbent, cp.stats.fails + cp.config.lns, false, fix);
+    cp.stats.lns_neighbourhoods++;
+    if(outcome == RunOutcome::EXHAUSTED && fixings.empty()) {
+      return;
+    }
+    if(incumbent.value.load() != before) {
+      cp.stats.lns_improvements++;
+    }
+    else if(outcome == RunOutcome::EXHAUSTED) {
+      relax = std::min(LNS_MAX_RELAX, relax * LNS_RELAX_GROWTH);
+    }
+    else if(outcome == RunOutcome::FAIL_LIMIT) {
+      relax = std::max(LNS_MIN_RELAX, relax / LNS_RELAX_GROWTH);
+    }
+  }
+  // Stopped by the timeout or CTRL-C: the neighbourhoods do not prove optimality, hence `==========` must not be printed.
+  cp.stats.exhaustive = false;
+}
+
+/** Dichotomic search on the objective for optimisation problems, it alternates between two kinds of runs from the root, each limited to `config.dichotomic` failures:
+ *  - A probe constraining the objective to the better half of the gap between the proven bound (initially the bound of the objective at the root) and the best solution.
+ *    A probe exhausting its search tree without solution proves that the optimum is in the other half.
+ *  - A branch and bound run, which proves the optimality if it exhausts its search tree.
+ * A first run without failure limit looks for a solution, before which there is no gap to split.
+ * The search is complete: it stops when the gap is empty.
+ */
+template <class A, class FPEngine, class Timepoint>
+void cpu_dichotomic_search(A& cp, FPEngine& fp_engine, const Timepoint& start) {
+  auto root = cp.search_tree->template snapshot<bt::standard_allocator>();
+  SharedIncumbent incumbent(cp.bab->is_minimization());
+  AVar obj = cp.bab->objective_var();
+  bool minimize = cp.bab->is_minimization();
+  // The optimum is in `[lower, upper]`, and the probes constrain the objective to `[lower, mid]` (minimisation) or `[mid, upper]` (maximisation).
+  int64_t lower = cp.store->project(obj).lb().value();
+  int64_t upper = cp.store->project(obj).ub().value();
+  int64_t mid = 0;
+  auto probe = [&](A& cp) {
+    if(minimize) {
+      cp.store->tell(obj, Itv(Itv::LB(static_cast<int>(lower)), Itv::UB(static_cast<int>(mid))));
+    }
+    else {
+      cp.store->tell(obj, Itv(Itv::LB(static_cast<int>(mid)), Itv::UB(static_cast<int>(upper))));
+    }
+  };
+  auto no_constraint = [](A&) {};
+  RunOutcome outcome = cpu_limited_search(cp, fp_engine, start, incumbent, std::numeric_limits<size_t>::max(), true, no_constraint);
+  while(outcome == RunOutcome::SOLUTION || outcome == RunOutcome::FAIL_LIMIT) {
+    if(minimize) {
+      upper = static_cast<int64_t>(incumbent.value.load()) - 1;
+    }
+    else {
+      lower = static_cast<int64_t>(incumbent.value.load()) + 1;
+    }
+    if(lower > upper) {
+      return;
+    }
+    mid = minimize ? lower + (upper - lower) / 2 : upper - (upper - lower) / 2;
+    cp.search_tree->restore(root);
+    cp.stats.dichotomic_probes++;
+    outcome = cpu_limited_search(cp, fp_engine, start, incumbent, cp.stats.fails + cp.config.dichotomic, true, probe);
+    if(outcome == RunOutcome::EXHAUSTED) {
+      cp.stats.dichotomic_refuted_halves++;
+      if(minimize) {
+        lower = mid + 1;
+      }
+      else {
+        upper = mid - 1;
+      }
+      outcome = RunOutcome::FAIL_LIMIT;
+    }
+    else if(outcome == RunOutcome::FAIL_LIMIT) {
+      cp.search_tree->restore(root);
+      outcome = cpu_limited_search(cp, fp_engine, start, incumbent, cp.stats.fails + cp.config.dichotomic, false, no_constraint);
+    }
+  }
+  if(outcome == RunOutcome::STOPPED) {
+    cp.stats.exhaustive = false;
+  }
+}
+
+/** The searches with a stack of decisions, with or without learning, and guided by the best solution with `config.solution_guided`. */
+template <class A, class FPEngine, class Brancher, class Timepoint>
+void cpu_decision_mode(A& cp, FPEngine& fp_engine, Brancher& brancher, const Timepoint& start) {
+  if(cp.config.solution_guided && cp.bab->is_optimization()) {
+    SolutionGuidedBrancher<A, Brancher> guided(brancher);
+    if(cp.config.learning) {
+      cpu_learning_search(cp, fp_engine, guided, start);
+    }
+    else {
+      cpu_decision_search(cp, fp_engine, guided, start);
+    }
+  }
+  else if(cp.config.learning) {
+    cpu_learning_search(cp, fp_engine, brancher, start);
+  }
+  else {
+    cpu_decision_search(cp, fp_engine, brancher, start);
+  }
+}
+
+/** `formula` is the formula interpreted in `cp` by `preprocess`, from which the decision variables are extracted (see `decision_variables`). */
+template <class A, class FPEngine, class Formula, class Timepoint>
+void cpu_sequential_search_mode(A& cp, FPEngine& fp_engine, const Formula& formula, const Timepoint& start) {
+  if(cp.config.lns != 0 && cp.bab->is_satisfaction() && cp.config.verbose_solving) {
+    printf("%% WARNING: The LNS is only used on optimisation problems, we solve this satisfaction problem with a complete search instead.\n");
+  }
+  if(cp.config.dichotomic != 0 && cp.bab->is_satisfaction() && cp.config.verbose_solving) {
+    printf("%% WARNING: The dichotomic search is only used on optimisation problems, we solve this satisfaction problem with a complete search instead.\n");
+  }
+  if(cp.config.lns != 0 && cp.bab->is_optimization()) {
+    if(cp.config.timeout_ms == 0) {
+      printf("%% WARNING: The LNS usually does not terminate by itself, it is stopped by CTRL-C or by a timeout (-t).\n");
+    }
+    cpu_lns_search(cp, fp_engine, formula, start);
+  }
+  else if(cp.config.dichotomic != 0 && cp.bab->is_optimization()) {
+    cpu_dichotomic_search(cp, fp_engine, start);
+  }
+  else if(cp.config.var_order != VarOrder::SPLIT) {
+    if(!cp.config.free_search && cp.config.verbose_solving) {
+      printf("%% WARNING: -var-order is used instead of the search annotations of the model, as in free search (-f).\n");
+    }
+    if(cp.config.var_order == VarOrder::DOM_WDEG) {
+      DomWDegBrancher<A> dom_wdeg(cp, decision_variables(cp, *formula));
+      cpu_decision_mode(cp, dom_wdeg, dom_wdeg, start);
+    }
+    else {
+      ActivityBrancher<A> activity(cp, decision_variables(cp, *formula));
+      cpu_decision_mode(cp, activity, activity, start);
+    }
+  }
+  else if(cp.config.learning || (cp.config.restart != RestartStrategy::NONE && cp.config.nogoods)
+    || (cp.config.solution_guided && cp.bab->is_optimization()))
+  {
+    SplitBrancher<A> split(cp);
+    cpu_decision_mode(cp, fp_engine, split, start);
+  }
+  else if(cp.config.restart != RestartStrategy::NONE) {
+    if(cp.config.verbose_solving) {
+      printf("%% WARNING: -restart follows the search strategy of the model, which takes the same decisions after each restart: the runs re-explore the same prefix of the search tree, only the bound of the best solution can change them (use -nogoods or -var-order).\n");
+    }
+    cpu_restart_search(cp, fp_engine, start);
+  }
+  else {
+    cpu_sequential_search(cp, fp_engine, start);
+  }
+}
+
+/** Whether `cpu_sequential_search_mode` uses the brancher of `config.var_order` as fixpoint engine, which propagates with a single thread. */
+bool is_brancher_fixpoint(const CP<Itv>& cp) {
+  const auto& config = cp.config;
+  bool lns_or_dichotomic = (config.lns != 0 || config.dichotomic != 0) && cp.bab->is_optimization();
+  return !lns_or_dichotomic && config.var_order != VarOrder::SPLIT;
+}
+
+/** Sequential search, where the propagation is possibly parallelized on `config.and_nodes` threads. */
+template <class Formula, class Timepoint>
+void cpu_sequential_solve(CP<Itv>& cp, const Formula& formula, const Timepoint& start) {
+  if(cp.config.and_nodes > 1 && !is_brancher_fixpoint(cp)) {
+    if(cp.config.verbose_solving) {
+      printf("%% Propagating with %zu threads.\n", cp.config.and_nodes);
+    }
+    CP<AtomicItv> atomic_cp(cp);
+    AsynchronousIterationCPU fp_engine(cp.config.and_nodes);
+    cpu_sequential_search_mode(atomic_cp, fp_engine, formula, start);
+    cp.join(atomic_cp);
+  }
+  else {
+    GaussSeidelIteration fp_engine;
+    cpu_sequential_search_mode(cp, fp_engine, formula, start);
+  }
+}
+
+/** `WorkerData` is the CPU counterpart of `BlockData`: it contains all the structures required by a thread to solve a subproblem, including its own copy of the problem (`cp`). */
+template <class WorkerCP>
+struct WorkerData {
+  using cp_type = WorkerCP;
+  using snapshot_type = typename WorkerCP::IST::template snapshot_type<bt::standard_allocator>;
+  using ipc_snapshot_type = typename WorkerCP::IPC::template snapshot_type<bt::standard_allocator>;
+  size_t subproblem_idx;
+  // The depth of the subproblem, which is always `config.subproblems_power` unless the EPS is adaptive.
+  size_t subproblem_depth;
+  GaussSeidelIteration fp_engine;
+  std::unique_ptr<WorkerCP> cp;
+  std::unique_ptr<snapshot_type> snapshot_root;
+  // The nodes propagated during the last dive (`dive_stack[i]` is the node at depth `i`), the number of fixpoint iterations needed to propagate each of them, and the subproblem of this dive.
+  std::vector<ipc_snapshot_type> dive_stack;
+  std::vector<size_t> dive_iterations;
+  size_t dive_idx;
+  size_t dive_depth;
+  // The depth of the current node below the subproblem when the worker explores it without `search_tree` (see `solve_problem_slice`).
+  size_t dfs_depth;
+
+  WorkerData(size_t idx, const CP<Itv>& root)
+    : subproblem_idx(idx)
+    , subproblem_depth(root.config.subproblems_power)
+    , cp(make_worker_cp<WorkerCP>(idx, root))
+    , snapshot_root(std::make_unique<snapshot_type>(cp->search_tree->template snapshot<bt::standard_allocator>()))
+    , dive_idx(0)
+    , dive_depth(0)
+    , dfs_depth(0)
+  {}
+
+  size_t depth() const {
+    return cp->search_tree->depth() + dfs_depth;
+  }
+
+  void restore() {
+    cp->search_tree->restore(*snapshot_root);
+    cp->eps_split->reset();
+    dfs_depth = 0;
+  }
+
+  /** The branch taken at depth `level` to reach the subproblem `idx` of depth `depth`. */
+  static size_t branch_of(size_t idx, size_t depth, size_t level) {
+    return (idx >> (depth - level - 1)) & size_t{1};
+  }
+
+  /** Restore the deepest node of the last dive which is also an ancestor of the current subproblem (after `restore`).
+   * \return The number of nodes of the dive which do not need to be propagated again, the last one being the node restored. */
+  size_t reuse_dive_prefix() {
+    size_t shared = 0;
+    if(!dive_stack.empty() && subproblem_depth > 0) {
+      while(shared + 1 < dive_stack.size() && shared + 1 < subproblem_depth && branch_of(subproblem_idx, subproblem_depth, shared) == branch_of(dive_idx, dive_depth, shared)) {
+        shared++;
+      }
+      shared++;
+      cp->ipc->restore(dive_stack[shared - 1]);
+      cp->stats.eps_reused_dive_nodes += shared;
+      for(size_t i = 0; i < shared; ++i) {
+        cp->stats.eps_saved_fixpoint_iterations += dive_iterations[i];
+      }
+    }
+    dive_stack.erase(dive_stack.begin() + shared, dive_stack.end());
+    dive_iterations.erase(dive_iterations.begin() + shared, dive_iterations.end());
+    dive_idx = subproblem_idx;
+    dive_depth = subproblem_depth;
+    return shared;
+  }
+
+  void push_dive_node(size_t iterations) {
+    dive_stack.push_back(cp->ipc->template snapshot<bt::standard_allocator>());
+    dive_iterations.push_back(iterations);
+  }
+};
+
+/** Follow the branches given by the bits of `w.subproblem_idx` down to the depth `w.subproblem_depth`.
+ * The dive starts from the deepest node shared with the previous dive of the worker, since consecutive subproblems share most of their branches.
+ * The solutions are given to `on_solution(cp)` (see `propagate`), and `end_node()` is called after each node propagated.
+ * \return `0` if we reached the subproblem, otherwise the remaining depth at which a leaf node was found, in which case the `2^remaining_depth` subproblems below this leaf can be skipped.
+ * As in `block_dive` on GPU, the objective must not be added during diving (this is also why the nodes of a dive can be reused).
+ */
+template <class WorkerCP, class OnSolution, class EndNode>
+size_t dive(WorkerData<WorkerCP>& w, ParallelData<WorkerData<WorkerCP>>& data, OnSolution on_solution, EndNode end_node) {
+  WorkerCP& cp = *w.cp;
+  size_t reused = w.reuse_dive_prefix();
+  size_t level = reused == 0 ? 0 : reused - 1;
+  while(level < w.subproblem_depth && !data.stop) {
+    if(level >= reused) {
+      local::BInc has_changed;
+      size_t iterations = cp.stats.fixpoint_iterations;
+      bool is_leaf_node = propagate(w, data, has_changed, on_solution);
+      end_node();
+      if(is_leaf_node) {
+        return w.subproblem_depth - level;
+      }
+      w.push_dive_node(cp.stats.fixpoint_iterations - iterations);
+    }
+    auto branches = cp.eps_split->split();
+    assert(branches.size() == 2);
+    cp.ipc->tell(branches[WorkerData<WorkerCP>::branch_of(w.subproblem_idx, w.subproblem_depth, level)]);
+    level++;
+  }
+  return w.subproblem_depth - level;
+}
+
+/** Same as above, but the solutions are directly shared with the other workers. */
+template <class WorkerCP>
+size_t dive(WorkerData<WorkerCP>& w, ParallelData<WorkerData<WorkerCP>>& data) {
+  return dive(w, data, [&](auto& cp) {
+    if(!data.on_solution_node(cp)) {
+      data.stop = true;
+    }
+  }, []() {});
+}
+
+/** Solve the subproblem reached by `dive`, with the same `on_solution` and `end_node` hooks. */
+template <class WorkerCP, class OnSolution, class EndNode>
+void solve_problem(WorkerData<WorkerCP>& w, ParallelData<WorkerData<WorkerCP>>& data, OnSolution on_solution, EndNode end_node) {
+  WorkerCP& cp = *w.cp;
+  local::BInc has_changed = true;
+  while(has_changed && !data.stop) {
+    has_changed = false;
+    update_worker_best_bound(w, data);
+    propagate(w, data, has_changed, on_solution);
     cp.search_tree->refine(has_changed);
+    end_node();
+  }
+}
+
+template <class WorkerCP>
+void solve_problem(WorkerData<WorkerCP>& w, ParallelData<WorkerData<WorkerCP>>& data) {
+  solve_problem(w, data, [&](auto& cp) {
+    if(!data.on_solution_node(cp)) {
+      data.stop = true;
+    }
+  }, []() {});
+}
+
+/** Solve the subproblem `w.subproblem_idx`, the subproblems from `end` onwards are not counted when skipped.
+ * \return The index of the next subproblem that is not skipped.
+ */
+template <class WorkerCP>
+size_t eps_solve_subproblem(WorkerData<WorkerCP>& w, ParallelData<WorkerData<WorkerCP>>& data, size_t end) {
+  w.restore();
+  size_t remaining_depth = dive(w, data);
+  if(remaining_depth == 0) {
+    solve_problem(w, data);
+    if(!data.stop) {
+      w.cp->stats.eps_solved_subproblems += 1;
+    }
+    return w.subproblem_idx + 1;
+  }
+  size_t next_subproblem_idx = ((w.subproblem_idx >> remaining_depth) + size_t{1}) << remaining_depth;
+  // Several threads might skip the same subproblems, hence only the thread solving the left most subproblem counts them.
+  if(!data.stop && (w.subproblem_idx & ((size_t{1} << remaining_depth) - size_t{1})) == size_t{0}) {
+    w.cp->stats.eps_skipped_subproblems += std::min(next_subproblem_idx, end) - w.subproblem_idx;
+  }
+  return next_subproblem_idx;
+}
+
+/** The function executed by each thread, it mirrors `gpu_solve_kernel`. */
+template <class WorkerCP>
+void cpu_eps_worker(ParallelData<WorkerData<WorkerCP>>& data, size_t worker_idx) {
+  WorkerData<WorkerCP>& w = data.workers[worker_idx];
+  const auto& config = data.root.config;
+  size_t num_subproblems = data.root.stats.eps_num_subproblems;
+  while(w.subproblem_idx < num_subproblems && !data.stop) {
+    if(config.verbose_solving) {
+      std::lock_guard<std::mutex> lock(data.print_lock);
+      printf("%% Thread %zu solves subproblem num %zu\n", worker_idx, w.subproblem_idx);
+    }
+    size_t next_subproblem_idx = eps_solve_subproblem(w, data, num_subproblems);
+    if(!data.stop) {
+      atomic_max(data.next_subproblem, next_subproblem_idx);
+      w.subproblem_idx = data.next_subproblem.fetch_add(1);
+    }
+  }
+  if(!data.stop) {
+    w.cp->stats.num_blocks_done = 1;
+  }
+}
+
+/** Embarrassingly parallel search (EPS) on CPU with `config.or_nodes` threads, each solving the subproblems in turns. */
+template <class WorkerCP, class Timepoint>
+void cpu_eps_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving with %zu threads and 2^%zu subproblems.\n", root.config.or_nodes, root.config.subproblems_power);
+  }
+  size_t num_subproblems = 1;
+  num_subproblems <<= root.config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  auto data = std::make_unique<ParallelData<WorkerData<WorkerCP>>>(root, root.config.or_nodes);
+  run_parallel(*data, cpu_eps_worker<WorkerCP>, start);
+}
+
+/** A worker process of the distributed EPS (see `distributed_solving.hpp`).
+ * Each of the `config.or_nodes` threads asks its own ranges of subproblems to the coordinator, and solves them as in `cpu_eps_worker`.
+ * The new solutions are sent to the coordinator as soon as they are found.
+ */
+template <class WorkerCP, class Timepoint>
+void cpu_distributed_eps_solve(CP<Itv>& root, const Timepoint& start) {
+#ifdef _WIN32
+  printf("%% ERROR: The distributed EPS is not supported on this platform.\n");
+  root.stats.exhaustive = false;
+#else
+  std::string address(root.config.connect_to.data());
+  CoordinatorConnection coordinator;
+  if(!coordinator.connect_to(address)) {
+    printf("%% ERROR: Cannot connect to the coordinator %s.\n", address.c_str());
+    root.stats.exhaustive = false;
+    return;
+  }
+  if(root.config.verbose_solving) {
+    printf("%% Solving the subproblems of the coordinator %s with %zu threads.\n", address.c_str(), root.config.or_nodes);
+  }
+  root.stats.eps_num_subproblems = size_t{1} << root.config.subproblems_power;
+  auto data = std::make_unique<ParallelData<WorkerData<WorkerCP>>>(root, root.config.or_nodes);
+  data->on_new_solution = [&]() { coordinator.send_solution(*root.best); };
+  run_parallel(*data, [&](ParallelData<WorkerData<WorkerCP>>& data, size_t worker_idx) {
+    WorkerData<WorkerCP>& w = data.workers[worker_idx];
+    size_t first = 0, end = 0;
+    while(!data.stop && coordinator.next_range(first, end, data.incumbent)) {
+      if(root.config.verbose_solving) {
+        std::lock_guard<std::mutex> lock(data.print_lock);
+        printf("%% Thread %zu solves the subproblems [%zu, %zu)\n", worker_idx, first, end);
+      }
+      w.subproblem_idx = first;
+      while(w.subproblem_idx < end && !data.stop) {
+        w.subproblem_idx = eps_solve_subproblem(w, data, end);
+      }
+    }
+    if(!data.stop) {
+      w.cp->stats.num_blocks_done = 1;
+    }
+  }, start);
+  coordinator.send_statistics(root.stats);
+#endif
+}
+
+/** The coordinator of the distributed EPS, it does not solve any subproblem itself. */
+template <class WorkerCP, class Timepoint>
+void cpu_coordinator_eps_solve(CP<Itv>& root, const Timepoint& start) {
+#ifdef _WIN32
+  printf("%% ERROR: The distributed EPS is not supported on this platform.\n");
+  root.stats.exhaustive = false;
+#else
+  cpu_coordinator_solve<WorkerData<WorkerCP>>(root, start);
+#endif
+}
+
+/** A subproblem suspended by `cpu_interleaved_eps_worker`.
+ * The search tree of the subproblem is explored in depth-first order without `search_tree`, as in `StealingWorker`: `node` is the next node to explore and `open_nodes` are the right branches not yet explored (the deepest at the back), each with its depth below the subproblem.
+ * Saving the search tree itself would not work, its snapshot only contains the root of the subproblem and not the branches already taken.
+ */
+template <class WorkerCP>
+struct SuspendedSubproblem {
+  using ipc_snapshot_type = typename WorkerData<WorkerCP>::ipc_snapshot_type;
+  struct OpenNode {
+    ipc_snapshot_type snapshot;
+    size_t depth;
+  };
+  size_t subproblem_idx;
+  OpenNode node;
+  std::vector<OpenNode> open_nodes;
+};
+
+/** Split the current node, push all its children except the left most one in the open nodes of `s`, and enter the left most child (see `branch` of `StealingWorker`).
+ * \return `false` if there is nothing left to split, the node is then a leaf. */
+template <class WorkerCP>
+bool branch(WorkerData<WorkerCP>& w, SuspendedSubproblem<WorkerCP>& s) {
+  WorkerCP& cp = *w.cp;
+  auto branches = cp.split->split();
+  if(branches.size() == 0) {
+    return false;
+  }
+  auto parent = cp.ipc->template snapshot<bt::standard_allocator>();
+  for(int i = branches.size() - 1; i > 0; --i) {
+    cp.ipc->restore(parent);
+    cp.ipc->tell(branches[i]);
+    s.open_nodes.push_back({cp.ipc->template snapshot<bt::standard_allocator>(), w.dfs_depth + 1});
+  }
+  cp.ipc->restore(parent);
+  cp.ipc->tell(branches[0]);
+  w.dfs_depth++;
+  return true;
+}
+
+/** Explore at most `max_nodes` nodes of the subproblem `s`, starting from `s.node`.
+ * \return `true` if the subproblem is completely explored (or the search must stop), otherwise the node where the exploration stopped is saved in `s.node`. */
+template <class WorkerCP>
+bool solve_problem_slice(WorkerData<WorkerCP>& w, ParallelData<WorkerData<WorkerCP>>& data, SuspendedSubproblem<WorkerCP>& s, size_t max_nodes) {
+  WorkerCP& cp = *w.cp;
+  cp.ipc->restore(s.node.snapshot);
+  cp.split->reset();
+  w.dfs_depth = s.node.depth;
+  for(size_t i = 0; i < max_nodes && !data.stop; ++i) {
+    local::BInc has_changed;
+    update_worker_best_bound(w, data);
+    if(propagate(w, data, has_changed) || !branch(w, s)) {
+      if(s.open_nodes.empty()) {
+        return true;
+      }
+      cp.ipc->restore(s.open_nodes.back().snapshot);
+      cp.split->reset();
+      w.dfs_depth = s.open_nodes.back().depth;
+      s.open_nodes.pop_back();
+    }
+  }
+  if(data.stop) {
+    return true;
+  }
+  s.node = {cp.ipc->template snapshot<bt::standard_allocator>(), w.dfs_depth};
+  return false;
+}
+
+/** Same as `cpu_eps_worker`, but each worker interleaves up to `config.interleave` subproblems.
+ * The subproblems are explored in turns, `INTERLEAVE_SLICE_NODES` nodes at a time, so a worker stuck in a large subproblem still makes progress on the others.
+ * Switching from a subproblem to another one saves and restores the current node (see `SuspendedSubproblem`), it is cheap compared to the exploration of the time slice.
+ * A subproblem is only counted as solved once all its open nodes are explored.
+ */
+template <class WorkerCP>
+void cpu_interleaved_eps_worker(ParallelData<WorkerData<WorkerCP>>& data, size_t worker_idx) {
+  WorkerData<WorkerCP>& w = data.workers[worker_idx];
+  WorkerCP& cp = *w.cp;
+  const auto& config = data.root.config;
+  size_t num_subproblems = data.root.stats.eps_num_subproblems;
+  std::deque<SuspendedSubproblem<WorkerCP>> suspended;
+  while(!data.stop) {
+    // Dive into new subproblems until the worker has `config.interleave` subproblems or none is left.
+    while(suspended.size() < config.interleave && w.subproblem_idx < num_subproblems && !data.stop) {
+      w.restore();
+      size_t remaining_depth = dive(w, data);
+      if(remaining_depth == 0) {
+        suspended.push_back({w.subproblem_idx, {cp.ipc->template snapshot<bt::standard_allocator>(), 0}, {}});
+      }
+      else if(!data.stop) {
+        size_t next_subproblem_idx = ((w.subproblem_idx >> remaining_depth) + size_t{1}) << remaining_depth;
+        atomic_max(data.next_subproblem, next_subproblem_idx);
+        if((w.subproblem_idx & ((size_t{1} << remaining_depth) - size_t{1})) == size_t{0}) {
+          cp.stats.eps_skipped_subproblems += next_subproblem_idx - w.subproblem_idx;
+        }
+      }
+      if(!data.stop) {
+        w.subproblem_idx = data.next_subproblem.fetch_add(1);
+      }
+    }
+    if(suspended.empty()) {
+      break;
+    }
+    SuspendedSubproblem<WorkerCP> current = std::move(suspended.front());
+    suspended.pop_front();
+    if(config.verbose_solving) {
+      std::lock_guard<std::mutex> lock(data.print_lock);
+      printf("%% Thread %zu resumes subproblem num %zu\n", worker_idx, current.subproblem_idx);
+    }
+    if(solve_problem_slice(w, data, current, INTERLEAVE_SLICE_NODES)) {
+      if(!data.stop) {
+        cp.stats.eps_solved_subproblems += 1;
+      }
+    }
+    else {
+      suspended.push_back(std::move(current));
+    }
+  }
+  if(!data.stop) {
+    cp.stats.num_blocks_done = 1;
+  }
+}
+
+template <class WorkerCP, class Timepoint>
+void cpu_interleaved_eps_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving with %zu threads, 2^%zu subproblems and %zu subproblems interleaved per thread.\n", root.config.or_nodes, root.config.subproblems_power, root.config.interleave);
+  }
+  size_t num_subproblems = 1;
+  num_subproblems <<= root.config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  auto data = std::make_unique<ParallelData<WorkerData<WorkerCP>>>(root, root.config.or_nodes);
+  run_parallel(*data, cpu_interleaved_eps_worker<WorkerCP>, start);
+}
+
+template <class WorkerCP>
+struct AdaptiveEPSData : public ParallelData<WorkerData<WorkerCP>> {
+  EPSGranularity granularity;
+
+  AdaptiveEPSData(CP<Itv>& root)
+    : ParallelData<WorkerData<WorkerCP>>(root, root.config.or_nodes)
+    , granularity(root.config.subproblems_power, root.config.or_nodes)
+  {}
+};
+
+/** Same as `cpu_eps_worker` but the subproblems are taken from `data.granularity`, and their depth changes during the search. */
+template <class WorkerCP>
+void cpu_adaptive_eps_worker(ParallelData<WorkerData<WorkerCP>>& parallel_data, size_t worker_idx) {
+  using clock = std::chrono::steady_clock;
+  auto& data = static_cast<AdaptiveEPSData<WorkerCP>&>(parallel_data);
+  WorkerData<WorkerCP>& w = data.workers[worker_idx];
+  EPSGranularity::Subproblem subproblem;
+  while(!data.stop && data.granularity.take(subproblem)) {
+    w.subproblem_idx = subproblem.idx;
+    w.subproblem_depth = subproblem.depth;
+    if(data.root.config.verbose_solving) {
+      std::lock_guard<std::mutex> lock(data.print_lock);
+      printf("%% Thread %zu solves subproblem num %zu at depth %zu\n", worker_idx, w.subproblem_idx, w.subproblem_depth);
+    }
+    auto start = clock::now();
+    w.restore();
+    size_t remaining_depth = dive(w, data);
+    auto dive_end = clock::now();
+    if(remaining_depth == 0) {
+      solve_problem(w, data);
+      if(!data.stop) {
+        w.cp->stats.eps_solved_subproblems += 1;
+      }
+    }
+    else if(!data.stop) {
+      size_t next_subproblem_idx = ((w.subproblem_idx >> remaining_depth) + size_t{1}) << remaining_depth;
+      data.granularity.skip_until(next_subproblem_idx, w.subproblem_depth);
+      if((w.subproblem_idx & ((size_t{1} << remaining_depth) - size_t{1})) == size_t{0}) {
+        w.cp->stats.eps_skipped_subproblems += next_subproblem_idx - w.subproblem_idx;
+      }
+    }
+    if(!data.stop) {
+      auto end = clock::now();
+      data.granularity.record(
+        std::chrono::duration<double, std::milli>(dive_end - start).count(),
+        std::chrono::duration<double, std::milli>(end - start).count(),
+        remaining_depth != 0);
+    }
+  }
+  if(!data.stop) {
+    w.cp->stats.num_blocks_done = 1;
+  }
+}
+
+/** EPS where the number of subproblems is adapted during the search (see `EPSGranularity`).
+ * Since the subproblems have different depths, `eps_num_subproblems` is the number of subproblems solved or skipped. */
+template <class WorkerCP, class Timepoint>
+void cpu_adaptive_eps_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving with %zu threads and initially 2^%zu subproblems.\n", root.config.or_nodes, root.config.subproblems_power);
+  }
+  auto data = std::make_unique<AdaptiveEPSData<WorkerCP>>(root);
+  run_parallel(*data, cpu_adaptive_eps_worker<WorkerCP>, start);
+  root.stats.eps_num_subproblems = root.stats.eps_solved_subproblems + root.stats.eps_skipped_subproblems;
+  if(root.config.verbose_solving) {
+    printf("%% The depth of the subproblems changed %zu times, the final depth is %zu.\n", data->granularity.num_changes(), data->granularity.current_depth());
+  }
+}
+
+/** The data of the bound-ordered EPS, only used for optimisation problems.
+ * In a first phase, the workers dive into all the subproblems and record the bound of the objective after propagation (`bounds`).
+ * At the end of this phase, the subproblems are sorted from the most to the least promising bound (`order`), and the workers solve them in this order in a second phase.
+ */
+template <class WorkerCP>
+struct BoundOrderedData : public ParallelData<WorkerData<WorkerCP>> {
+  struct EndFirstPhase {
+    BoundOrderedData* data;
+    void operator()() noexcept {
+      data->sort_subproblems();
+    }
+  };
+
+  std::vector<int> bounds;
+  // `false` if the subproblem failed during its dive or its propagation, or was skipped.
+  std::vector<char> reached;
+  std::vector<size_t> order;
+  std::atomic<size_t> next_ordered;
+  std::barrier<EndFirstPhase> end_first_phase;
+
+  BoundOrderedData(CP<Itv>& root)
+    : ParallelData<WorkerData<WorkerCP>>(root, root.config.or_nodes)
+    , bounds(root.stats.eps_num_subproblems, 0)
+    , reached(root.stats.eps_num_subproblems, false)
+    , next_ordered(0)
+    , end_first_phase(root.config.or_nodes, EndFirstPhase{this})
+  {
+    order.reserve(root.stats.eps_num_subproblems);
+  }
+
+  void sort_subproblems() noexcept {
+    for(size_t i = 0; i < reached.size(); ++i) {
+      if(reached[i]) {
+        order.push_back(i);
+      }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return this->incumbent.is_better(bounds[a], bounds[b]);
+    });
+  }
+};
+
+/** The function executed by each thread in the bound-ordered EPS.
+ * The first phase is the same as `cpu_eps_worker`, except that the subproblems are only propagated and not solved.
+ * In the second phase, a subproblem whose bound cannot improve the best solution is pruned, and since the subproblems are sorted, all the subproblems after it are pruned too.
+ */
+template <class WorkerCP>
+void cpu_bound_ordered_eps_worker(ParallelData<WorkerData<WorkerCP>>& parallel_data, size_t worker_idx) {
+  auto& data = static_cast<BoundOrderedData<WorkerCP>&>(parallel_data);
+  WorkerData<WorkerCP>& w = data.workers[worker_idx];
+  WorkerCP& cp = *w.cp;
+  size_t num_subproblems = data.root.stats.eps_num_subproblems;
+  while(w.subproblem_idx < num_subproblems && !data.stop) {
+    w.restore();
+    size_t remaining_depth = dive(w, data);
+    if(remaining_depth == 0) {
+      // `dive` does not propagate the subproblem itself, only its ancestors.
+      cp.stats.fixpoint_iterations += w.fp_engine.fixpoint(*cp.ipc);
+      if(cp.ipc->is_top()) {
+        cp.stats.eps_skipped_subproblems += 1;
+      }
+      else {
+        data.bounds[w.subproblem_idx] = data.incumbent.value_of(*cp.store, cp.bab->objective_var());
+        data.reached[w.subproblem_idx] = true;
+      }
+    }
+    else if(!data.stop) {
+      size_t next_subproblem_idx = ((w.subproblem_idx >> remaining_depth) + size_t{1}) << remaining_depth;
+      atomic_max(data.next_subproblem, next_subproblem_idx);
+      if((w.subproblem_idx & ((size_t{1} << remaining_depth) - size_t{1})) == size_t{0}) {
+        cp.stats.eps_skipped_subproblems += next_subproblem_idx - w.subproblem_idx;
+      }
+    }
+    if(!data.stop) {
+      w.subproblem_idx = data.next_subproblem.fetch_add(1);
+    }
+  }
+  data.end_first_phase.arrive_and_wait();
+  size_t num_ordered = data.order.size();
+  for(size_t i = data.next_ordered.fetch_add(1); i < num_ordered && !data.stop; i = data.next_ordered.fetch_add(1)) {
+    w.subproblem_idx = data.order[i];
+    if(!data.incumbent.is_better(data.bounds[w.subproblem_idx], data.incumbent.value.load())) {
+      size_t first_pruned = data.next_ordered.exchange(num_ordered);
+      cp.stats.eps_pruned_subproblems += 1 + (first_pruned < num_ordered ? num_ordered - first_pruned : 0);
+      break;
+    }
+    if(data.root.config.verbose_solving) {
+      std::lock_guard<std::mutex> lock(data.print_lock);
+      printf("%% Thread %zu solves subproblem num %zu (bound %d)\n", worker_idx, w.subproblem_idx, data.bounds[w.subproblem_idx]);
+    }
+    w.restore();
+    // The dive reaches the subproblem since it did in the first phase.
+    if(dive(w, data) == 0) {
+      solve_problem(w, data);
+    }
+    if(!data.stop) {
+      cp.stats.eps_solved_subproblems += 1;
+    }
+  }
+  if(!data.stop) {
+    cp.stats.num_blocks_done = 1;
+  }
+}
+
+/** EPS where the subproblems of an optimisation problem are solved in the order of their bound (see `BoundOrderedData`). */
+template <class WorkerCP, class Timepoint>
+void cpu_bound_ordered_eps_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.bab->is_satisfaction()) {
+    if(root.config.verbose_solving) {
+      printf("%% WARNING: The subproblems of a satisfaction problem cannot be ordered by bound, we solve them in the default order.\n");
+    }
+    cpu_eps_solve<WorkerCP>(root, start);
+    return;
+  }
+  if(root.config.verbose_solving) {
+    printf("%% Solving with %zu threads and 2^%zu subproblems ordered by bound.\n", root.config.or_nodes, root.config.subproblems_power);
+  }
+  size_t num_subproblems = 1;
+  num_subproblems <<= root.config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  auto data = std::make_unique<BoundOrderedData<WorkerCP>>(root);
+  run_parallel(*data, cpu_bound_ordered_eps_worker<WorkerCP>, start);
+}
+
+/** A node of the EPS frontier, stored compactly as the domains that differ from the root node. */
+struct FrontierNode {
+  struct Domain {
+    int var;
+    int lb;
+    int ub;
+  };
+  size_t subproblem_idx;
+  std::vector<Domain> delta;
+};
+
+/** The data of the EPS with a pre-generated frontier.
+ * Instead of diving from the root for each subproblem, the EPS tree is expanded once, level by level and in parallel, down to the depth `subproblems_power`.
+ * The failed nodes are discarded during the expansion, so the workers are only given the subproblems surviving the propagation, which they load directly (`load`).
+ */
+template <class WorkerCP>
+struct FrontierData : public ParallelData<WorkerData<WorkerCP>> {
+  struct EndLevel {
+    FrontierData* data;
+    void operator()() noexcept {
+      data->next_level();
+    }
+  };
+
+  std::vector<Itv> root_domains;
+  // The nodes of the current level, sorted by subproblem index.
+  std::vector<FrontierNode> frontier;
+  // The children generated by each worker during the expansion of the current level.
+  std::vector<std::vector<FrontierNode>> children;
+  std::atomic<size_t> next_node;
+  size_t level;
+  std::barrier<EndLevel> end_level;
+
+  FrontierData(CP<Itv>& root)
+    : ParallelData<WorkerData<WorkerCP>>(root, root.config.or_nodes)
+    , children(root.config.or_nodes)
+    , next_node(0)
+    , level(0)
+    , end_level(root.config.or_nodes, EndLevel{this})
+  {
+    for(size_t i = 0; i < root.store->vars(); ++i) {
+      root_domains.push_back((*root.store)[i]);
+    }
+    frontier.push_back(FrontierNode{0, {}});
+  }
+
+  void next_level() noexcept {
+    frontier.clear();
+    for(auto& c : children) {
+      std::move(c.begin(), c.end(), std::back_inserter(frontier));
+      c.clear();
+    }
+    std::sort(frontier.begin(), frontier.end(), [](const FrontierNode& a, const FrontierNode& b) {
+      return a.subproblem_idx < b.subproblem_idx;
+    });
+    next_node = 0;
+    level++;
+  }
+
+  template <class Store>
+  FrontierNode make_node(size_t subproblem_idx, const Store& store) const {
+    FrontierNode node{subproblem_idx, {}};
+    for(size_t i = 0; i < root_domains.size(); ++i) {
+      int lb = store[i].lb().value();
+      int ub = store[i].ub().value();
+      if(lb != root_domains[i].lb().value() || ub != root_domains[i].ub().value()) {
+        node.delta.push_back(FrontierNode::Domain{static_cast<int>(i), lb, ub});
+      }
+    }
+    return node;
+  }
+
+  void load(WorkerData<WorkerCP>& w, const FrontierNode& node) const {
+    w.restore();
+    for(const auto& d : node.delta) {
+      w.cp->store->tell(d.var, Itv(Itv::LB(d.lb), Itv::UB(d.ub)));
+    }
+  }
+};
+
+/** Split `node` with `eps_split` and keep its children which are not leaf nodes after propagation.
+ * The nodes are stored after propagation, so we only need to recompute the fixpoint when loading them, except for the root node. */
+template <class WorkerCP>
+void expand_frontier_node(WorkerData<WorkerCP>& w, FrontierData<WorkerCP>& data, const FrontierNode& node, size_t worker_idx) {
+  WorkerCP& cp = *w.cp;
+  data.load(w, node);
+  local::BInc has_changed;
+  if(data.level == 0) {
+    if(propagate(w, data, has_changed)) {
+      return;
+    }
+  }
+  else {
+    cp.stats.fixpoint_iterations += w.fp_engine.fixpoint(*cp.ipc, has_changed);
+  }
+  auto parent = cp.ipc->template snapshot<bt::standard_allocator>();
+  auto branches = cp.eps_split->split();
+  assert(branches.size() == 2);
+  for(int b = 0; b < 2 && !data.stop; ++b) {
+    cp.ipc->restore(parent);
+    cp.ipc->tell(branches[b]);
+    local::BInc child_changed;
+    if(!propagate(w, data, child_changed)) {
+      data.children[worker_idx].push_back(data.make_node(node.subproblem_idx * 2 + b, *cp.store));
+    }
+  }
+}
+
+/** The function executed by each thread: the workers first expand the frontier together, and then solve the subproblems of the frontier in turns. */
+template <class WorkerCP>
+void cpu_frontier_eps_worker(ParallelData<WorkerData<WorkerCP>>& parallel_data, size_t worker_idx) {
+  auto& data = static_cast<FrontierData<WorkerCP>&>(parallel_data);
+  WorkerData<WorkerCP>& w = data.workers[worker_idx];
+  for(size_t level = 0; level < data.root.config.subproblems_power; ++level) {
+    for(size_t i = data.next_node.fetch_add(1); i < data.frontier.size() && !data.stop; i = data.next_node.fetch_add(1)) {
+      expand_frontier_node(w, data, data.frontier[i], worker_idx);
+    }
+    data.end_level.arrive_and_wait();
+  }
+  for(size_t i = data.next_node.fetch_add(1); i < data.frontier.size() && !data.stop; i = data.next_node.fetch_add(1)) {
+    w.subproblem_idx = data.frontier[i].subproblem_idx;
+    if(data.root.config.verbose_solving) {
+      std::lock_guard<std::mutex> lock(data.print_lock);
+      printf("%% Thread %zu solves subproblem num %zu\n", worker_idx, w.subproblem_idx);
+    }
+    data.load(w, data.frontier[i]);
+    solve_problem(w, data);
+    if(!data.stop) {
+      w.cp->stats.eps_solved_subproblems += 1;
+    }
+  }
+  if(!data.stop) {
+    w.cp->stats.num_blocks_done = 1;
+  }
+}
+
+/** EPS where the subproblems are generated and propagated once before being solved (see `FrontierData`).
+ * The subproblems discarded during the generation are counted in `eps_skipped_subproblems`. */
+template <class WorkerCP, class Timepoint>
+void cpu_frontier_eps_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving with %zu threads and a frontier of at most 2^%zu subproblems.\n", root.config.or_nodes, root.config.subproblems_power);
+  }
+  size_t num_subproblems = 1;
+  num_subproblems <<= root.config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  auto data = std::make_unique<FrontierData<WorkerCP>>(root);
+  run_parallel(*data, cpu_frontier_eps_worker<WorkerCP>, start);
+  if(data->level == root.config.subproblems_power) {
+    root.stats.eps_skipped_subproblems += num_subproblems - data->frontier.size();
+    if(root.config.verbose_solving) {
+      printf("%% The frontier contains %zu subproblems.\n", data->frontier.size());
+    }
+  }
+}
+
+/** The data of the deterministic EPS, where the workers synchronize at the end of each epoch.
+ * The epoch of a worker ends after `DETERMINISTIC_EPOCH_NODES` nodes, or as soon as it finds a solution.
+ * The solutions found during an epoch are shared with the other workers only at the end of the epoch, in the order of the workers, so the best bound does not change during an epoch.
+ */
+template <class WorkerCP>
+struct DeterministicData : public ParallelData<WorkerData<WorkerCP>> {
+  using base_type = ParallelData<WorkerData<WorkerCP>>;
+
+  struct EndEpoch {
+    DeterministicData* data;
+    void operator()() noexcept {
+      data->end_epoch();
+    }
+  };
+
+  std::vector<char> has_solution;
+  std::vector<size_t> epoch_start;
+  size_t epochs;
+  std::barrier<EndEpoch> barrier;
+
+  DeterministicData(CP<Itv>& root)
+    : base_type(root, root.config.or_nodes)
+    , has_solution(root.config.or_nodes, false)
+    , epoch_start(root.config.or_nodes, 0)
+    , epochs(0)
+    , barrier(root.config.or_nodes, EndEpoch{this})
+  {}
+
+  /** Executed by a single thread when all the workers reached the end of the epoch. */
+  void end_epoch() noexcept {
+    for(size_t i = 0; i < has_solution.size(); ++i) {
+      if(has_solution[i]) {
+        has_solution[i] = false;
+        if(!this->on_solution_node(*this->workers[i].cp)) {
+          this->stop = true;
+        }
+      }
+    }
+    epochs++;
+  }
+
+  /** Called by the worker `i` after each node, it waits for the other workers when its epoch is over. */
+  void end_node(size_t i) {
+    size_t nodes = this->workers[i].cp->stats.nodes;
+    if(has_solution[i] || nodes - epoch_start[i] >= DETERMINISTIC_EPOCH_NODES) {
+      barrier.arrive_and_wait();
+      epoch_start[i] = nodes;
+    }
+  }
+};
+
+/** The function executed by each thread in the deterministic EPS.
+ * Instead of taking the next available subproblem, the worker `i` solves the subproblems `i, i + n, i + 2n, ...`.
+ * When a leaf node is found during diving, the worker only skips its own subproblems below this leaf.
+ */
+template <class WorkerCP>
+void cpu_deterministic_eps_worker(ParallelData<WorkerData<WorkerCP>>& parallel_data, size_t worker_idx) {
+  auto& data = static_cast<DeterministicData<WorkerCP>&>(parallel_data);
+  WorkerData<WorkerCP>& w = data.workers[worker_idx];
+  size_t num_workers = data.workers.size();
+  size_t num_subproblems = data.root.stats.eps_num_subproblems;
+  // The solutions are only shared at the end of the epoch, so the best bound does not change during an epoch.
+  auto on_solution = [&](auto&) { data.has_solution[worker_idx] = true; };
+  auto end_node = [&]() { data.end_node(worker_idx); };
+  while(w.subproblem_idx < num_subproblems && !data.stop) {
+    w.restore();
+    size_t remaining_depth = dive(w, data, on_solution, end_node);
+    size_t next_subproblem_idx = w.subproblem_idx + num_workers;
+    if(remaining_depth == 0) {
+      solve_problem(w, data, on_solution, end_node);
+      if(!data.stop) {
+        w.cp->stats.eps_solved_subproblems += 1;
+      }
+    }
+    else if(!data.stop) {
+      size_t leaf_end = ((w.subproblem_idx >> remaining_depth) + size_t{1}) << remaining_depth;
+      while(next_subproblem_idx < leaf_end) {
+        next_subproblem_idx += num_workers;
+      }
+      w.cp->stats.eps_skipped_subproblems += (next_subproblem_idx - w.subproblem_idx) / num_workers;
+    }
+    w.subproblem_idx = next_subproblem_idx;
+  }
+  if(!data.stop) {
+    w.cp->stats.num_blocks_done = 1;
+  }
+  // The worker does not participate in the next epochs, but its last solution (if any) is still shared at the end of the current epoch.
+  data.barrier.arrive_and_drop();
+}
+
+/** Deterministic EPS: with the same number of threads, two runs explore the same nodes and find the same solutions (unless they are interrupted by the timeout or CTRL-C). */
+template <class WorkerCP, class Timepoint>
+void cpu_deterministic_eps_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving deterministically with %zu threads and 2^%zu subproblems.\n", root.config.or_nodes, root.config.subproblems_power);
+  }
+  size_t num_subproblems = 1;
+  num_subproblems <<= root.config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  auto data = std::make_unique<DeterministicData<WorkerCP>>(root);
+  run_parallel<WorkerData<WorkerCP>>(*data, cpu_deterministic_eps_worker<WorkerCP>, start);
+  if(root.config.verbose_solving) {
+    printf("%% Number of epochs: %zu\n", data->epochs);
+  }
+}
+
+/** `true` if `cpu_solve` solves the problem sequentially, the portfolio being replaced by a sequential search to enumerate the solutions of a satisfaction problem. */
+bool is_sequential_solve(const CP<Itv>& cp) {
+  const auto& config = cp.config;
+  if(config.coordinator_port != 0 || config.connect_to.size() != 0) {
+    return false;
+  }
+  if(config.portfolio > 1 && cp.bab->is_satisfaction() && config.stop_after_n_solutions != 1) {
+    return true;
+  }
+  return config.or_nodes <= 1 && config.portfolio <= 1;
+}
+
+/** Warn about the options ignored by `cpu_solve` because of other options, in the order of precedence of `cpu_parallel_solve` and `cpu_sequential_search_mode`. */
+void warn_ignored_options(const CP<Itv>& cp) {
+  const auto& config = cp.config;
+  auto warn = [](bool ignored, const char* option, const char* reason) {
+    if(ignored) {
+      printf("%% WARNING: %s is ignored, %s.\n", option, reason);
+    }
+  };
+  bool distributed = config.coordinator_port != 0 || config.connect_to.size() != 0;
+  bool sequential = is_sequential_solve(cp);
+  if(sequential) {
+    warn(config.learning && config.restart != RestartStrategy::NONE, "-restart", "-learn does not restart");
+    warn(config.lns != 0 && config.dichotomic != 0, "-dichotomic", "-lns is used instead");
+    warn(config.numa, "-numa", "the problem is solved sequentially");
+    warn(config.and_nodes > 1 && is_brancher_fixpoint(cp), "-and", "-var-order propagates with a single thread");
+  }
+  else {
+    const char* reason = "it is only used when solving sequentially";
+    warn(config.restart != RestartStrategy::NONE, "-restart", reason);
+    warn(config.nogoods, "-nogoods", reason);
+    warn(config.learning, "-learn", reason);
+    warn(config.var_order != VarOrder::SPLIT, "-var-order", reason);
+    warn(config.solution_guided, "-solution-guided", reason);
+    warn(config.lns != 0, "-lns", reason);
+    warn(config.dichotomic != 0, "-dichotomic", reason);
+  }
+  if(config.coordinator_port != 0) {
+    warn(config.connect_to.size() != 0, "-connect", "a coordinator does not solve any subproblem");
+  }
+  // The parallel searches by order of precedence, and whether they can be used: only the first one used is effective.
+  const std::tuple<bool, bool, const char*> modes[] = {
+    {config.deterministic, config.or_nodes > 1, "-deterministic"},
+    {config.portfolio > 1, true, "-portfolio"},
+    {config.work_stealing, config.or_nodes > 1, "-ws"},
+    {config.adaptive_eps, config.or_nodes > 1, "-adaptive"},
+    {config.bound_ordered_eps, config.or_nodes > 1, "-bound-order"},
+    {config.eps_frontier, config.or_nodes > 1, "-frontier"},
+    {config.interleave > 1, config.or_nodes > 1, "-interleave"}
+  };
+  const char* used = nullptr;
+  for(const auto& [enabled, usable, option] : modes) {
+    if(!enabled) {
+      continue;
+    }
+    if(distributed) {
+      warn(true, option, "the distributed EPS is used instead");
+    }
+    else if(sequential) {
+      warn(true, option, config.portfolio > 1
+        ? "the portfolio cannot enumerate the solutions of a satisfaction problem, it is solved sequentially"
+        : "the problem is solved sequentially");
+    }
+    else if(used != nullptr) {
+      printf("%% WARNING: %s is ignored, %s is used instead.\n", option, used);
+    }
+    else if(!usable) {
+      warn(true, option, "it is only used with -p greater than 1");
+    }
+    else {
+      used = option;
+    }
+  }
+}
+
+/** The parallel and distributed searches, the threads solve the problem on copies of type `WorkerCP`. */
+template <class WorkerCP, class Formula, class Timepoint>
+void cpu_parallel_solve(CP<Itv>& cp, const Formula& formula, const Timepoint& start) {
+  if(cp.config.connect_to.size() != 0) {
+    cpu_distributed_eps_solve<WorkerCP>(cp, start);
+  }
+  else if(cp.config.or_nodes > 1 && cp.config.deterministic) {
+    cpu_deterministic_eps_solve<WorkerCP>(cp, start);
+  }
+  else if(cp.config.portfolio > 1) {
+    cpu_portfolio_solve<WorkerCP>(cp, formula, start);
+  }
+  else if(cp.config.work_stealing) {
+    cpu_work_stealing_solve<WorkerCP>(cp, start);
+  }
+  else if(cp.config.adaptive_eps) {
+    cpu_adaptive_eps_solve<WorkerCP>(cp, start);
+  }
+  else if(cp.config.bound_ordered_eps) {
+    cpu_bound_ordered_eps_solve<WorkerCP>(cp, start);
+  }
+  else if(cp.config.eps_frontier) {
+    cpu_frontier_eps_solve<WorkerCP>(cp, start);
+  }
+  else if(cp.config.interleave > 1) {
+    cpu_interleaved_eps_solve<WorkerCP>(cp, start);
+  }
+  else {
+    cpu_eps_solve<WorkerCP>(cp, start);
+  }
+}
+
+void cpu_solve(const Configuration<battery::standard_allocator>& config) {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  CP<Itv> cp(config);
+  auto formula = cp.preprocess();
+  if(cp.config.auto_threads) {
+    ThreadCalibration calibration = calibrate_cpu_threads(cp);
+    cp.config.or_nodes = calibration.threads;
+    cp.config.subproblems_power = calibration.subproblems_power;
+    if(cp.config.verbose_solving) {
+      printf("%% Calibration: %zu cores available, %.3fms per node, solving with %zu threads and 2^%zu subproblems.\n",
+        calibration.available_cores, calibration.node_ms, calibration.threads, calibration.subproblems_power);
+    }
+    if(cp.config.print_statistics) {
+      calibration.print_mzn_statistics();
+    }
+  }
+
+  block_signal_ctrlc();
+  warn_ignored_options(cp);
+  if(cp.config.coordinator_port != 0) {
+    cpu_coordinator_eps_solve<CP<Itv>>(cp, start);
+  }
+  else if(is_sequential_solve(cp)) {
+    cpu_sequential_solve(cp, formula, start);
+  }
+  else if(cp.config.numa) {
+    cpu_parallel_solve<NumaCP>(cp, formula, start);
+  }
+  else {
+    cpu_parallel_solve<CP<Itv>>(cp, formula, start);
   }
   cp.print_final_solution();
   cp.print_mzn_statistics();
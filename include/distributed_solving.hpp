@@ -0,0 +1,363 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_DISTRIBUTED_SOLVING_HPP
+#define TURBO_DISTRIBUTED_SOLVING_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+  #include <netdb.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+#endif
+
+#include "common_solving.hpp"
+#include "cpu_parallel.hpp"
+
+/** Distributed EPS: a coordinator process (`-coordinator <port>`) hands out ranges of EPS subproblems to worker processes (`-connect <host>:<port>`), possibly on other machines.
+ * Every process parses and preprocesses the same model, hence the subproblems and the variables are the same everywhere.
+ * The messages are lines of text over TCP:
+ *  - worker to coordinator: `RANGE [<first> <end>]` to ask for subproblems (with the range the thread just explored, if any), `SOL <n> <lb_0> <ub_0> ... <lb_n-1> <ub_n-1>` with the domains of a new solution, and `STATS ...` with the statistics of the worker when it terminates.
+ *  - coordinator to worker: `RANGE <first> <end> <bound>` (the bound of the best solution found so far, or `none`), or `END` when no subproblem is left.
+ * The coordinator prints the solutions and the statistics merged with `Statistics::join`, the workers also print their own solutions on their standard output.
+ */
+
+#ifndef _WIN32
+
+/** A TCP connection exchanging lines of text. */
+class LineSocket {
+  int fd;
+  std::string buffer;
+
+public:
+  LineSocket(int fd): fd(fd) {}
+  LineSocket(const LineSocket&) = delete;
+
+  ~LineSocket() {
+    if(fd >= 0) {
+      close(fd);
+    }
+  }
+
+  int descriptor() const {
+    return fd;
+  }
+
+  bool send_line(const std::string& line) {
+    std::string msg = line + "\n";
+    size_t sent = 0;
+    while(sent < msg.size()) {
+      ssize_t n = send(fd, msg.data() + sent, msg.size() - sent, MSG_NOSIGNAL);
+      if(n < 0 && errno == EINTR) {
+        continue;
+      }
+      if(n <= 0) {
+        return false;
+      }
+      sent += n;
+    }
+    return true;
+  }
+
+  /** Read the data available on the socket, blocking until at least some data is received.
+   * \return `false` if the connection is closed. */
+  bool receive() {
+    char data[4096];
+    ssize_t n;
+    do {
+      n = recv(fd, data, sizeof(data), 0);
+    } while(n < 0 && errno == EINTR);
+    if(n <= 0) {
+      return false;
+    }
+    buffer.append(data, n);
+    return true;
+  }
+
+  /** Extract the next complete line received, if any. */
+  bool next_line(std::string& line) {
+    size_t end = buffer.find('\n');
+    if(end == std::string::npos) {
+      return false;
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+  }
+
+  /** Block until a complete line is received. */
+  bool read_line(std::string& line) {
+    while(!next_line(line)) {
+      if(!receive()) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+/** The statistics of a worker, without the solutions which are counted by the coordinator when it receives them. */
+inline std::string serialize_statistics(const Statistics& stats) {
+  std::ostringstream out;
+  out << "STATS " << stats.nodes << " " << stats.fails << " " << stats.depth_max << " " << stats.exhaustive
+      << " " << stats.eps_solved_subproblems << " " << stats.eps_skipped_subproblems << " " << stats.eps_pruned_subproblems
+      << " " << stats.eps_reused_dive_nodes << " " << stats.eps_saved_fixpoint_iterations
+      << " " << stats.num_blocks_done << " " << stats.fixpoint_iterations;
+  return out.str();
+}
+
+inline bool deserialize_statistics(std::istringstream& in, Statistics& stats) {
+  in >> stats.nodes >> stats.fails >> stats.depth_max >> stats.exhaustive
+     >> stats.eps_solved_subproblems >> stats.eps_skipped_subproblems >> stats.eps_pruned_subproblems
+     >> stats.eps_reused_dive_nodes >> stats.eps_saved_fixpoint_iterations
+     >> stats.num_blocks_done >> stats.fixpoint_iterations;
+  stats.solutions = 0;
+  return !in.fail();
+}
+
+template <class Store>
+std::string serialize_solution(const Store& sol) {
+  std::ostringstream out;
+  out << "SOL " << sol.vars();
+  for(size_t i = 0; i < sol.vars(); ++i) {
+    out << " " << sol[i].lb().value() << " " << sol[i].ub().value();
+  }
+  return out.str();
+}
+
+/** A connection of the coordinator to a worker. */
+struct WorkerConnection {
+  std::unique_ptr<LineSocket> socket;
+  // `true` when the worker sent its statistics, so it explored all the subproblems it received.
+  bool done;
+  // The ranges `[first, end)` given to the threads of the worker and not explored yet.
+  std::vector<std::pair<size_t, size_t>> ranges;
+};
+
+/** Receive a solution from a worker: its domains are told in the store of `w`, which is then processed as a solution node of `data`. */
+template <class Worker>
+void receive_solution(Worker& w, ParallelData<Worker>& data, std::istringstream& in) {
+  auto& cp = *w.cp;
+  size_t n;
+  in >> n;
+  w.restore();
+  for(size_t i = 0; i < n; ++i) {
+    int lb, ub;
+    in >> lb >> ub;
+    cp.store->tell(static_cast<int>(i), Itv(Itv::LB(lb), Itv::UB(ub)));
+  }
+  if(in.fail()) {
+    return;
+  }
+  local::BInc has_changed;
+  propagate(w, data, has_changed);
+}
+
+/** The coordinator: it answers the requests of the workers until all the subproblems are explored, or until the timeout or CTRL-C.
+ * The ranges of a worker which disconnects before sending its statistics are given again to the next requests, before the subproblems never given.
+ * Without timeout, the coordinator waits for the workers as long as subproblems are left, but it stops if no worker connected during the first `DISTRIBUTED_CONNECT_TIMEOUT_MS` milliseconds.
+ * `Worker` is only used to decode the solutions received. */
+template <class Worker, class Timepoint>
+void cpu_coordinator_solve(CP<Itv>& root, const Timepoint& start) {
+  size_t num_subproblems = size_t{1} << root.config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  ParallelData<Worker> data(root, 1);
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  int yes = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<uint16_t>(root.config.coordinator_port));
+  if(listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 64) != 0) {
+    printf("%% ERROR: The coordinator cannot listen on port %zu (%s).\n", root.config.coordinator_port, strerror(errno));
+    root.stats.exhaustive = false;
+    return;
+  }
+  if(root.config.verbose_solving) {
+    printf("%% Coordinator listening on port %zu, 2^%zu subproblems are distributed by ranges of %d.\n", root.config.coordinator_port, root.config.subproblems_power, DISTRIBUTED_RANGE_SIZE);
+  }
+  std::vector<WorkerConnection> workers;
+  std::vector<std::pair<size_t, size_t>> requeue;
+  size_t next_subproblem = 0;
+  bool connected_once = false;
+  while(!must_quit() && check_timeout(root, start)) {
+    bool no_work_left = data.stop || (next_subproblem >= num_subproblems && requeue.empty());
+    if(no_work_left && connected_once && workers.empty()) {
+      break;
+    }
+    if(!connected_once && root.stats.duration >= DISTRIBUTED_CONNECT_TIMEOUT_MS) {
+      printf("%% ERROR: No worker connected to the coordinator during %d milliseconds.\n", DISTRIBUTED_CONNECT_TIMEOUT_MS);
+      break;
+    }
+    std::vector<pollfd> fds{{listener, POLLIN, 0}};
+    for(auto& w : workers) {
+      fds.push_back({w.socket->descriptor(), POLLIN, 0});
+    }
+    if(poll(fds.data(), fds.size(), 100) <= 0) {
+      continue;
+    }
+    if(fds[0].revents & POLLIN) {
+      int fd = accept(listener, nullptr, nullptr);
+      if(fd >= 0) {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        workers.push_back({std::make_unique<LineSocket>(fd), false, {}});
+        connected_once = true;
+      }
+    }
+    for(size_t i = fds.size() - 1; i > 0; --i) {
+      if(fds[i].revents == 0) {
+        continue;
+      }
+      WorkerConnection& conn = workers[i - 1];
+      bool alive = conn.socket->receive();
+      std::string line;
+      while(alive && conn.socket->next_line(line)) {
+        std::istringstream in(line);
+        std::string kind;
+        in >> kind;
+        if(kind == "RANGE") {
+          std::pair<size_t, size_t> explored;
+          if(in >> explored.first >> explored.second) {
+            auto r = std::find(conn.ranges.begin(), conn.ranges.end(), explored);
+            if(r != conn.ranges.end()) {
+              conn.ranges.erase(r);
+            }
+          }
+          std::pair<size_t, size_t> range{0, 0};
+          if(!data.stop && !requeue.empty()) {
+            range = requeue.back();
+            requeue.pop_back();
+          }
+          else if(!data.stop && next_subproblem < num_subproblems) {
+            range = {next_subproblem, std::min(num_subproblems, next_subproblem + DISTRIBUTED_RANGE_SIZE)};
+            next_subproblem = range.second;
+          }
+          if(range.first == range.second) {
+            alive = conn.socket->send_line("END");
+          }
+          else {
+            int bound = data.incumbent.value.load();
+            std::string b = bound == data.incumbent.no_value() ? "none" : std::to_string(bound);
+            alive = conn.socket->send_line("RANGE " + std::to_string(range.first) + " " + std::to_string(range.second) + " " + b);
+            conn.ranges.push_back(range);
+          }
+        }
+        else if(kind == "SOL") {
+          receive_solution(data.workers[0], data, in);
+        }
+        else if(kind == "STATS") {
+          Statistics stats;
+          if(deserialize_statistics(in, stats)) {
+            root.stats.join(stats);
+            conn.done = true;
+          }
+        }
+      }
+      if(!alive) {
+        // The subproblems given to a worker which disconnected before sending its statistics are given to the next requests.
+        if(!conn.done) {
+          if(root.config.verbose_solving && !conn.ranges.empty()) {
+            printf("%% A worker disconnected, its %zu ranges of subproblems are given again.\n", conn.ranges.size());
+          }
+          requeue.insert(requeue.end(), conn.ranges.begin(), conn.ranges.end());
+        }
+        workers.erase(workers.begin() + (i - 1));
+      }
+    }
+  }
+  if(!workers.empty() || next_subproblem < num_subproblems || !requeue.empty()) {
+    root.stats.exhaustive = false;
+  }
+  close(listener);
+}
+
+/** The connection of a worker process to the coordinator, shared by all the threads of the worker.
+ * The requests of ranges are serialized by `request_lock`, and `send_lock` prevents the lines sent by different threads from being interleaved.
+ */
+class CoordinatorConnection {
+  std::unique_ptr<LineSocket> socket;
+  std::mutex request_lock;
+  std::mutex send_lock;
+
+  bool send_line(const std::string& line) {
+    std::lock_guard<std::mutex> guard(send_lock);
+    return socket->send_line(line);
+  }
+
+public:
+  /** Connect to `address` of the form `host:port` (or only `port` on the local host). */
+  bool connect_to(const std::string& address) {
+    size_t colon = address.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+    std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    int fd = -1;
+    if(getaddrinfo(host.c_str(), port.c_str(), &hints, &res) == 0) {
+      for(addrinfo* p = res; p != nullptr && fd < 0; p = p->ai_next) {
+        fd = ::socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if(fd >= 0 && ::connect(fd, p->ai_addr, p->ai_addrlen) != 0) {
+          close(fd);
+          fd = -1;
+        }
+      }
+      freeaddrinfo(res);
+    }
+    if(fd < 0) {
+      return false;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    socket = std::make_unique<LineSocket>(fd);
+    return true;
+  }
+
+  /** Ask a new range of subproblems `[first, end)` to the coordinator, the best bound known by the coordinator is given to `incumbent`.
+   * The previous range `[first, end)` of the thread, if not empty, is reported as explored.
+   * \return `false` if no subproblem is left or if the connection is lost. */
+  bool next_range(size_t& first, size_t& end, SharedIncumbent& incumbent) {
+    std::lock_guard<std::mutex> guard(request_lock);
+    std::string request = first < end ? "RANGE " + std::to_string(first) + " " + std::to_string(end) : "RANGE";
+    std::string line;
+    if(!send_line(request) || !socket->read_line(line)) {
+      return false;
+    }
+    std::istringstream in(line);
+    std::string kind, bound;
+    in >> kind >> first >> end >> bound;
+    if(kind != "RANGE" || in.fail()) {
+      return false;
+    }
+    if(bound != "none") {
+      incumbent.improve(std::stoi(bound));
+    }
+    return true;
+  }
+
+  template <class Store>
+  void send_solution(const Store& sol) {
+    send_line(serialize_solution(sol));
+  }
+
+  void send_statistics(const Statistics& stats) {
+    send_line(serialize_statistics(stats));
+  }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_EPS_GRANULARITY_HPP
+#define TURBO_EPS_GRANULARITY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "cpu_parallel.hpp"
+
+/** `EPSGranularity` adapts the depth of the EPS decomposition while the subproblems are solved.
+ * The subproblems are positions in a binary tree of depth `max_depth`: the subproblem `i` at depth `d` covers the positions `[i * 2^(max_depth - d), (i + 1) * 2^(max_depth - d))`.
+ * Hence, subproblems of different depths can be mixed, and the workers take them from left to right, `next_position` being the first position not taken yet.
+ *
+ * After each subproblem, the worker records the time spent diving and solving it, and whether it failed during diving.
+ * Every `num_workers` subproblems, the depth of the remaining subproblems is changed:
+ *  - deeper when less than `ADAPTIVE_EPS_MIN_SUBPROBLEMS` subproblems per worker remain, otherwise some workers will starve at the end of the search;
+ *  - shallower when diving takes more than `ADAPTIVE_EPS_MAX_DIVE_RATIO` of the solving time, or when most subproblems fail during diving, since the workers spend their time re-diving from the root.
+ */
+class EPSGranularity {
+  size_t min_depth;
+  size_t max_depth;
+  size_t num_workers;
+  std::atomic<size_t> depth;
+  std::atomic<size_t> next_position;
+
+  std::mutex lock;
+  double avg_dive_ms;
+  double avg_total_ms;
+  double fail_rate;
+  size_t samples;
+  size_t changes;
+
+  static constexpr double alpha = 0.1;
+
+  size_t end_position() const {
+    return size_t{1} << max_depth;
+  }
+
+  size_t remaining_subproblems(size_t d) const {
+    return (end_position() - std::min(end_position(), next_position.load())) >> (max_depth - d);
+  }
+
+public:
+  struct Subproblem {
+    size_t idx;
+    size_t depth;
+  };
+
+  EPSGranularity(size_t initial_depth, size_t num_workers)
+    : num_workers(num_workers)
+    , next_position(0)
+    , avg_dive_ms(0)
+    , avg_total_ms(0)
+    , fail_rate(0)
+    , samples(0)
+    , changes(0)
+  {
+    // There must be at least two subproblems per worker.
+    min_depth = 1;
+    while((size_t{1} << min_depth) < 2 * num_workers) {
+      min_depth++;
+    }
+    max_depth = std::min<size_t>(ADAPTIVE_EPS_MAX_SUBPROBLEMS_POWER, std::max(initial_depth, min_depth) + ADAPTIVE_EPS_DEPTH_RANGE);
+    depth = std::clamp(initial_depth, min_depth, max_depth);
+  }
+
+  size_t current_depth() const {
+    return depth;
+  }
+
+  size_t num_changes() const {
+    return changes;
+  }
+
+  /** Take the next subproblem at the current depth.
+   * If `next_position` is not aligned on a subproblem of this depth (because the depth decreased), a deeper subproblem is taken instead.
+   * \return `false` if no subproblem is left. */
+  bool take(Subproblem& s) {
+    size_t pos = next_position.load();
+    while(pos < end_position()) {
+      size_t d = depth.load(std::memory_order_relaxed);
+      while(d < max_depth && pos % (size_t{1} << (max_depth - d)) != 0) {
+        d++;
+      }
+      if(next_position.compare_exchange_weak(pos, pos + (size_t{1} << (max_depth - d)))) {
+        s = Subproblem{pos >> (max_depth - d), d};
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Skip all the subproblems before the subproblem `idx` at depth `d`. */
+  void skip_until(size_t idx, size_t d) {
+    atomic_max(next_position, idx << (max_depth - d));
+  }
+
+  void record(double dive_ms, double total_ms, bool failed_in_dive) {
+    std::lock_guard<std::mutex> guard(lock);
+    avg_dive_ms = (1 - alpha) * avg_dive_ms + alpha * dive_ms;
+    avg_total_ms = (1 - alpha) * avg_total_ms + alpha * total_ms;
+    fail_rate = (1 - alpha) * fail_rate + alpha * (failed_in_dive ? 1.0 : 0.0);
+    if(++samples < num_workers) {
+      return;
+    }
+    samples = 0;
+    size_t d = depth;
+    if(d < max_depth && remaining_subproblems(d) < ADAPTIVE_EPS_MIN_SUBPROBLEMS * num_workers) {
+      depth = d + 1;
+      changes++;
+    }
+    else if(d > min_depth
+      && remaining_subproblems(d - 1) >= 2 * ADAPTIVE_EPS_MIN_SUBPROBLEMS * num_workers
+      && (avg_dive_ms > ADAPTIVE_EPS_MAX_DIVE_RATIO * avg_total_ms || fail_rate > ADAPTIVE_EPS_MAX_FAIL_RATE))
+    {
+      depth = d - 1;
+      changes++;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,207 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_GPU_EMULATION_HPP
+#define TURBO_GPU_EMULATION_HPP
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common_solving.hpp"
+#include "block_search.hpp"
+#include "cpu_fixpoint.hpp"
+#include "cpu_parallel.hpp"
+
+/** The emulation of `gpu_solve_kernel` on CPU, used by `gpu_solve` when Turbo is compiled without CUDA and with `GPU_EMULATION=ON` (`TURBO_GPU_EMULATION`).
+ * Each block is a CPU thread, and the `and_nodes` threads of a block are emulated by the threads of `AsynchronousIterationCPU`.
+ * The search of a block is the one of the GPU (see block_search.hpp), including the sharing of the best bound through `best_bound`.
+ * The scheduling of the subproblems is the same as on GPU, including its races (e.g. two blocks can take the same subproblem), hence the options `-or`, `-and` and `-sub` can be studied without a GPU.
+ * The timings are not representative of a GPU, but the number of nodes, skipped subproblems and solutions are.
+ */
+
+template <class BlockCP>
+struct EmulatedBlockData;
+
+/** `EmulatedGridData` is the CPU counterpart of `GridData`. */
+template <class BlockCP>
+struct EmulatedGridData {
+  CP<Itv>& root;
+  std::deque<EmulatedBlockData<BlockCP>> blocks;
+  // Stop from the CPU, for instance because of a timeout.
+  std::atomic<bool> cpu_stop;
+  // Stop from a block, for instance because we found a solution.
+  std::unique_ptr<BInc<bt::atomic_memory<>>> gpu_stop;
+  std::atomic<size_t> next_subproblem;
+  std::atomic<size_t> blocks_done;
+  // As in `GridData`, the best bound is an interval in atomic memory told by all the blocks.
+  std::unique_ptr<AtomicItv> best_bound;
+  std::mutex print_lock;
+  StatisticsRegistry<bt::standard_allocator> live_stats;
+
+  EmulatedGridData(CP<Itv>& root)
+    : root(root)
+    , cpu_stop(false)
+    , gpu_stop(std::make_unique<BInc<bt::atomic_memory<>>>(false))
+    , next_subproblem(root.config.or_nodes)
+    , blocks_done(0)
+    , best_bound(std::make_unique<AtomicItv>())
+    , live_stats(root.config.or_nodes)
+  {
+    for(size_t i = 0; i < root.config.or_nodes; ++i) {
+      blocks.emplace_back(i, root);
+      blocks.back().root->live = live_stats.slot(i);
+    }
+  }
+
+  /** On GPU, the solution is transferred to the CPU where it is printed. */
+  template <class BlockBAB>
+  void produce_solution(const BlockBAB& bab) {
+    std::lock_guard<std::mutex> lock(print_lock);
+    // Another block might have produced a better solution between `update_grid_best_bound` and the lock.
+    if(bab.is_optimization() && !root.best->is_bot() && !bab.compare_bound(bab.optimum(), *root.best)) {
+      return;
+    }
+    if(!cpu_stop) {
+      bab.extract(*(root.bab));
+      root.print_solution();
+    }
+  }
+};
+
+/** `EmulatedBlockData` is the CPU counterpart of `BlockData`. */
+template <class BlockCP>
+struct EmulatedBlockData {
+  using U0 = typename BlockCP::universe_type;
+  using allocator_type = bt::standard_allocator;
+  using snapshot_type = typename BlockCP::IST::template snapshot_type<bt::standard_allocator>;
+  size_t subproblem_idx;
+  std::unique_ptr<AsynchronousIterationCPU> fp_engine;
+  std::unique_ptr<local::BInc> has_changed;
+  std::unique_ptr<local::BInc> stop;
+  std::unique_ptr<BlockCP> root;
+  std::unique_ptr<snapshot_type> snapshot_root;
+
+  EmulatedBlockData(size_t idx, const CP<Itv>& grid_root)
+    : subproblem_idx(idx)
+    , fp_engine(std::make_unique<AsynchronousIterationCPU>(grid_root.config.and_nodes))
+    , has_changed(std::make_unique<local::BInc>(true))
+    , stop(std::make_unique<local::BInc>(false))
+    , root(std::make_unique<BlockCP>(grid_root))
+    , snapshot_root(std::make_unique<snapshot_type>(root->search_tree->template snapshot<bt::standard_allocator>()))
+  {}
+
+  void restore() {
+    root->search_tree->restore(*snapshot_root);
+    root->eps_split->reset();
+  }
+};
+
+/** The function executed by the thread of the block `block_idx`, it mirrors `gpu_solve_kernel`. */
+template <class BlockCP>
+void emulated_gpu_solve_kernel(EmulatedGridData<BlockCP>& grid_data, size_t block_idx) {
+  size_t num_subproblems = grid_data.root.stats.eps_num_subproblems;
+  EmulatedBlockData<BlockCP>& block_data = grid_data.blocks[block_idx];
+  while(block_data.subproblem_idx < num_subproblems && !*(block_data.stop)) {
+    if(grid_data.root.config.verbose_solving) {
+      std::lock_guard<std::mutex> lock(grid_data.print_lock);
+      printf("%% Block %zu solves subproblem num %zu\n", block_idx, block_data.subproblem_idx);
+    }
+    block_data.restore();
+    size_t remaining_depth = block_dive(block_data, grid_data);
+    if(remaining_depth == 0) {
+      block_solve_problem(block_data, grid_data);
+      if(!*(block_data.stop)) {
+        block_data.root->stats.eps_solved_subproblems += 1;
+      }
+    }
+    else if(!*(block_data.stop)) {
+      size_t next_subproblem_idx = ((block_data.subproblem_idx >> remaining_depth) + size_t{1}) << remaining_depth;
+      atomic_max(grid_data.next_subproblem, next_subproblem_idx);
+      // It is possible that several blocks skip similar subproblems. Hence, we only count the subproblems skipped by the block solving the left most subproblem.
+      if((block_data.subproblem_idx & ((size_t{1} << remaining_depth) - size_t{1})) == size_t{0}) {
+        block_data.root->stats.eps_skipped_subproblems += next_subproblem_idx - block_data.subproblem_idx;
+      }
+    }
+    // Load next problem: as on GPU, reading and incrementing `next_subproblem` are two distinct operations.
+    if(!*(block_data.stop)) {
+      block_data.subproblem_idx = grid_data.next_subproblem.load();
+      atomic_max(grid_data.next_subproblem, block_data.subproblem_idx + size_t{1});
+    }
+  }
+  if(!*(block_data.stop)) {
+    block_data.root->stats.num_blocks_done = 1;
+  }
+}
+
+template <class BlockCP, class Timepoint>
+void emulate_and_run(CP<Itv>& root, const Timepoint& start) {
+  auto& config = root.config;
+  size_t num_cpus = std::max(1u, std::thread::hardware_concurrency());
+  config.or_nodes = (config.or_nodes == 0) ? num_cpus : config.or_nodes;
+  config.and_nodes = (config.and_nodes == 0) ? 1 : config.and_nodes;
+  if(config.verbose_solving) {
+    printf("%% GPU emulated on CPU with %zu blocks of %zu threads.\n", config.or_nodes, config.and_nodes);
+    if(config.or_nodes * config.and_nodes > num_cpus) {
+      printf("%% WARNING: The %zu emulated threads are more than the %zu CPUs, the timings are not representative.\n", config.or_nodes * config.and_nodes, num_cpus);
+    }
+    printf("%% and_nodes=%zu\n", config.and_nodes);
+    printf("%% or_nodes=%zu\n", config.or_nodes);
+  }
+  size_t num_subproblems = 1;
+  num_subproblems <<= config.subproblems_power;
+  root.stats.eps_num_subproblems = num_subproblems;
+  auto grid_data = std::make_unique<EmulatedGridData<BlockCP>>(root);
+  std::vector<std::thread> blocks;
+  for(size_t i = 0; i < config.or_nodes; ++i) {
+    blocks.emplace_back([&grid_data, i]() {
+      emulated_gpu_solve_kernel(*grid_data, i);
+      grid_data->blocks_done += 1;
+    });
+  }
+  int64_t next_live_print = LIVE_STATISTICS_PERIOD_MS;
+  while(!must_quit() && check_timeout(root, start) && grid_data->blocks_done < config.or_nodes) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if(config.verbose_solving && root.stats.duration >= next_live_print) {
+      std::lock_guard<std::mutex> lock(grid_data->print_lock);
+      grid_data->live_stats.print(root.stats.duration);
+      next_live_print += LIVE_STATISTICS_PERIOD_MS;
+    }
+  }
+  if(grid_data->blocks_done < config.or_nodes) {
+    grid_data->cpu_stop = true;
+    root.stats.exhaustive = false;
+  }
+  for(auto& t : blocks) {
+    t.join();
+  }
+  // See `reduce_blocks`.
+  for(auto& block : grid_data->blocks) {
+    root.join(*block.root);
+  }
+  root.print_final_solution();
+  root.print_mzn_statistics();
+}
+
+void emulated_gpu_solve(Configuration<bt::standard_allocator>& config) {
+  auto start = std::chrono::high_resolution_clock::now();
+  CP<Itv> root(config);
+  root.preprocess();
+  block_signal_ctrlc();
+  if(root.config.noatomics && root.config.and_nodes > 1) {
+    if(root.config.verbose_solving) {
+      printf("%% WARNING: -noatomics is ignored with -and greater than 1, the threads of a block propagate in the same store concurrently.\n");
+    }
+    root.config.noatomics = false;
+  }
+  if(root.config.noatomics) {
+    emulate_and_run<CP<Itv>>(root, start);
+  }
+  else {
+    emulate_and_run<CP<AtomicItv>>(root, start);
+  }
+}
+
+#endif
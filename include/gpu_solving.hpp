@@ -4,6 +4,8 @@
 #define TURBO_GPU_SOLVING_HPP
 
 #include "common_solving.hpp"
+#include "block_search.hpp"
+#include "gpu_emulation.hpp"
 #include <thread>
 #include <algorithm>
 #include <cuda/std/chrono>
@@ -143,12 +145,15 @@ struct GridData {
   bt::shared_ptr<cuda::binary_semaphore<cuda::thread_scope_device>, bt::global_allocator> print_lock;
   cuda::std::atomic_flag ready_to_produce;
   cuda::std::atomic_flag ready_to_consume;
+  // The statistics of each block, read by the CPU while the kernel is running.
+  StatisticsRegistry<ConcurrentAllocator> live_stats;
 
   GridData(const GridCP& root, const MemoryConfig& mem_config)
     : root(root)
     , mem_config(mem_config)
     , cpu_stop(false)
     , blocks_reduced(false)
+    , live_stats(root.config.or_nodes)
   {
     ready_to_consume.clear();
     ready_to_produce.test_and_set();
@@ -218,11 +223,14 @@ struct GridData {
   }
 };
 
-/** `BlockData` contains all the structures required to solve a subproblem including the problem itself (`root`) and the fixpoint engine (`fp_engine`). */
+/** `BlockData` contains all the structures required to solve a subproblem including the problem itself (`root`) and the fixpoint engine (`fp_engine`).
+ * The search of the block is in block_search.hpp. */
 template <class S>
 struct BlockData {
   using GridCP = typename S::GridCP;
   using BlockCP = typename S::BlockCP;
+  using U0 = typename S::U0;
+  using allocator_type = bt::global_allocator;
 
   using snapshot_type = typename BlockCP::IST::snapshot_type<bt::global_allocator>;
   size_t subproblem_idx;
@@ -255,6 +263,7 @@ public:
         bt::global_allocator{},
         mem_config.make_pc_pool(shared_mem_pool),
         mem_config.make_store_pool(shared_mem_pool));
+      root->live = grid_data.live_stats.slot(blockIdx.x);
       snapshot_root = bt::make_shared<snapshot_type, bt::global_allocator>(root->search_tree->template snapshot<bt::global_allocator>());
     }
     block.sync();
@@ -294,167 +303,6 @@ __global__ void deallocate_grid_data(GridData<S>* grid_data) {
   grid_data->deallocate();
 }
 
-/** We update the bound found by the current block so it is visible to all other blocks.
- * Note that this operation might not always succeed, which is okay, the best bound is still preserved in `block_data` and then reduced at the end (in `reduce_blocks`).
- * The worst that can happen is that a best bound is found twice, which does not prevent the correctness of the algorithm.
- */
-template <class S>
-__device__ void update_grid_best_bound(BlockData<S>& block_data, GridData<S>& grid_data, local::BInc& best_has_changed) {
-  using U0 = typename S::U0;
-  if(threadIdx.x == 0 && block_data.root->bab->is_optimization()) {
-    const auto& bab = block_data.root->bab;
-    auto local_best = bab->optimum().project(bab->objective_var());
-    // printf("[new bound] %d: [%d..%d] (current best: [%d..%d])\n", blockIdx.x, local_best.lb().value(), local_best.ub().value(), grid_data.best_bound->lb().value(), grid_data.best_bound->ub().value());
-    if(bab->is_maximization()) {
-      grid_data.best_bound->tell_lb(dual<typename U0::LB>(local_best.ub()), best_has_changed);
-    }
-    else {
-      grid_data.best_bound->tell_ub(dual<typename U0::UB>(local_best.lb()), best_has_changed);
-    }
-  }
-}
-
-/** This function updates the best bound of the current block according to the best bound found so far across blocks.
- * We directly update the store with the best bound.
- * This function should be called in each node, since the best bound is erased on backtracking (it is not included in the snapshot).
- */
-template <class S>
-__device__ void update_block_best_bound(BlockData<S>& block_data, GridData<S>& grid_data) {
-  using U0 = typename S::U0;
-  if(threadIdx.x == 0 && block_data.root->bab->is_optimization()) {
-    const auto& bab = block_data.root->bab;
-    VarEnv<bt::global_allocator> empty_env{};
-    auto best_formula = bab->template deinterpret_best_bound<bt::global_allocator>(
-      bab->is_maximization()
-      ? U0(dual<typename U0::UB>(grid_data.best_bound->lb()))
-      : U0(dual<typename U0::LB>(grid_data.best_bound->ub())));
-    // printf("global best: "); grid_data.best_bound->ub().print(); printf("\n");
-    // best_formula.print(); printf("\n");
-    IDiagnostics diagnostics;
-    interpret_and_tell(best_formula, empty_env, *block_data.root->store, diagnostics);
-  }
-}
-
-/** Propagate a node of the search tree and process the leaf nodes (failed or solution).
- * Branching on unknown nodes is a task left to the caller.
- */
-template <class S>
-__device__ bool propagate(BlockData<S>& block_data, GridData<S>& grid_data, local::BInc& thread_has_changed) {
-  using BlockCP = typename S::BlockCP;
-  bool is_leaf_node = false;
-  BlockCP& cp = *block_data.root;
-  auto& fp_engine = *block_data.fp_engine;
-#ifdef TURBO_PROFILE_MODE
-  cuda::std::chrono::system_clock::time_point start;
-  if(threadIdx.x == 0) {
-    start = cuda::std::chrono::system_clock::now();
-  }
-  fp_engine.barrier();
-#endif
-  size_t iterations = fp_engine.fixpoint(*cp.ipc, thread_has_changed, &grid_data.cpu_stop);
-  if(threadIdx.x == 0) {
-#ifdef TURBO_PROFILE_MODE
-    auto end = cuda::std::chrono::system_clock::now();
-    cuda::std::chrono::duration<double> diff = end - start;
-    cp.stats.propagation_time += diff.count();
-#endif
-    cp.stats.fixpoint_iterations += iterations;
-    cp.on_node();
-    if(cp.ipc->is_top()) {
-      is_leaf_node = true;
-      cp.on_failed_node();
-    }
-    else if(cp.search_tree->template is_extractable<AtomicExtraction>()) {
-      is_leaf_node = true;
-      if(cp.bab->is_satisfaction() || cp.bab->compare_bound(*cp.store, cp.bab->optimum())) {
-        cp.bab->refine(thread_has_changed);
-        bool do_not_stop = cp.update_solution_stats();
-        if(!do_not_stop) {
-          grid_data.gpu_stop->tell_top();
-        }
-        local::BInc best_has_changed;
-        update_grid_best_bound(block_data, grid_data, best_has_changed);
-        if(best_has_changed && cp.is_printing_intermediate_sol()) {
-          grid_data.produce_solution(*cp.bab);
-        }
-      }
-    }
-#ifdef TURBO_PROFILE_MODE
-    if(cp.stats.nodes >= cp.config.stop_after_n_nodes) {
-      grid_data.gpu_stop->tell_top();
-    }
-    auto end2 = cuda::std::chrono::system_clock::now();
-    diff = end2 - end;
-    cp.stats.search_time += diff.count();
-#endif
-  }
-  return is_leaf_node;
-}
-
-/** The initial problem tackled during the dive must always be the same.
- * Hence, don't be tempted to add the objective during diving because it might lead to ignoring some subproblems since the splitting decisions will differ.
- */
-template <class S>
-__device__ size_t dive(BlockData<S>& block_data, GridData<S>& grid_data) {
-  using BlockCP = typename S::BlockCP;
-  BlockCP& cp = *block_data.root;
-  auto& fp_engine = *block_data.fp_engine;
-  auto& stop = *block_data.stop;
-  // Note that we use `block_has_changed` to stop the "diving", not really to indicate something has changed or not (since we do not need this information for this algorithm).
-  auto& stop_diving = *block_data.has_changed;
-  stop.dtell_bot();
-  stop_diving.dtell_bot();
-  fp_engine.barrier();
-  size_t remaining_depth = grid_data.root.config.subproblems_power;
-  while(remaining_depth > 0 && !stop_diving && !stop) {
-    remaining_depth--;
-    local::BInc thread_has_changed;
-    bool is_leaf_node = propagate(block_data, grid_data, thread_has_changed);
-    if(threadIdx.x == 0) {
-      if(is_leaf_node) {
-        stop_diving.tell_top();
-      }
-      else {
-        size_t branch_idx = (block_data.subproblem_idx & (size_t{1} << remaining_depth)) >> remaining_depth;
-        auto branches = cp.eps_split->split();
-        assert(branches.size() == 2);
-        cp.ipc->tell(branches[branch_idx]);
-      }
-      stop.tell(local::BInc(grid_data.cpu_stop || *(grid_data.gpu_stop)));
-    }
-    fp_engine.barrier();
-  }
-  return remaining_depth;
-}
-
-template <class S>
-__device__ void solve_problem(BlockData<S>& block_data, GridData<S>& grid_data) {
-  using BlockCP = typename S::BlockCP;
-  BlockCP& cp = *block_data.root;
-  auto& fp_engine = *block_data.fp_engine;
-  auto& block_has_changed = *block_data.has_changed;
-  auto& stop = *block_data.stop;
-  block_has_changed.tell_top();
-  stop.dtell_bot();
-  fp_engine.barrier();
-  // In the condition, we must only read variables that are local to this block.
-  // Otherwise, two threads might read different values if it is changed in between by another block.
-  while(block_has_changed && !stop) {
-    // For correctness we need this local variable, we cannot use `block_has_changed` (because it might still need to be read by other threads to enter this loop).
-    local::BInc thread_has_changed;
-    update_block_best_bound(block_data, grid_data);
-    propagate(block_data, grid_data, thread_has_changed);
-    if(threadIdx.x == 0) {
-      stop.tell(local::BInc(grid_data.cpu_stop || *(grid_data.gpu_stop)));
-      cp.search_tree->refine(thread_has_changed);
-    }
-    block_has_changed.dtell_bot();
-    fp_engine.barrier();
-    block_has_changed.tell(thread_has_changed);
-    fp_engine.barrier();
-  }
-}
-
 template <class S>
 CUDA void reduce_blocks(GridData<S>* grid_data) {
   for(int i = 0; i < grid_data->blocks.size(); ++i) {
@@ -482,9 +330,9 @@ __global__ void gpu_solve_kernel(GridData<S>* grid_data)
     }
     block_data.restore();
     cooperative_groups::this_thread_block().sync();
-    size_t remaining_depth = dive(block_data, *grid_data);
+    size_t remaining_depth = block_dive(block_data, *grid_data);
     if(remaining_depth == 0) {
-      solve_problem(block_data, *grid_data);
+      block_solve_problem(block_data, *grid_data);
       if(threadIdx.x == 0 && !*(block_data.stop)) {
         block_data.root->stats.eps_solved_subproblems += 1;
       }
@@ -623,8 +471,13 @@ bool wait_solving_ends(GridData<S>& grid_data, const Timepoint& start) {
   cudaEvent_t event;
   cudaEventCreateWithFlags(&event,cudaEventDisableTiming);
   cudaEventRecord(event);
+  int64_t next_live_print = LIVE_STATISTICS_PERIOD_MS;
   while(!must_quit() && check_timeout(grid_data.root, start) && cudaEventQuery(event) == cudaErrorNotReady) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if(grid_data.root.config.verbose_solving && grid_data.root.stats.duration >= next_live_print) {
+      grid_data.live_stats.print(grid_data.root.stats.duration);
+      next_live_print += LIVE_STATISTICS_PERIOD_MS;
+    }
   }
   if(cudaEventQuery(event) == cudaErrorNotReady) {
     grid_data.cpu_stop = true;
@@ -777,7 +630,11 @@ void check_support_concurrent_managed_memory() {
 
 void gpu_solve(Configuration<bt::standard_allocator>& config) {
 #ifndef __CUDACC__
-  std::cerr << "You must use a CUDA compiler (nvcc or clang) to compile Turbo on GPU." << std::endl;
+  #ifdef TURBO_GPU_EMULATION
+    emulated_gpu_solve(config);
+  #else
+    std::cerr << "You must use a CUDA compiler (nvcc or clang) to compile Turbo on GPU (or build with GPU_EMULATION=ON to emulate the GPU on CPU)." << std::endl;
+  #endif
 #else
   check_support_unified_memory();
   check_support_concurrent_managed_memory();
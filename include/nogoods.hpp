@@ -0,0 +1,134 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_NOGOODS_HPP
+#define TURBO_NOGOODS_HPP
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "common_solving.hpp"
+
+/** A bound literal `x <= value` (`upper`) or `x >= value`. */
+struct BoundLiteral {
+  int var;
+  bool upper;
+  int value;
+
+  template <class Store>
+  bool is_entailed(const Store& store) const {
+    return upper ? store[var].ub().value() <= value : store[var].lb().value() >= value;
+  }
+
+  template <class Store>
+  bool is_disentailed(const Store& store) const {
+    return upper ? store[var].lb().value() > value : store[var].ub().value() < value;
+  }
+
+  template <class Store>
+  void tell(Store& store) const {
+    if(upper) {
+      store.tell(var, Itv(Itv::LB::bot(), Itv::UB(value)));
+    }
+    else {
+      store.tell(var, Itv(Itv::LB(value), Itv::UB::bot()));
+    }
+  }
+
+  /** Tell the negation of the literal in `store`. */
+  template <class Store>
+  void tell_negation(Store& store) const {
+    if(upper) {
+      store.tell(var, Itv(Itv::LB(value + 1), Itv::UB::bot()));
+    }
+    else {
+      store.tell(var, Itv(Itv::LB::bot(), Itv::UB(value - 1)));
+    }
+  }
+};
+
+/** The literals describing how the branch told after `bounds` (the bounds of the store before the branch) narrowed `store`.
+ * A branch of a split strategy only constrains the domain of the variables, usually of a single variable, hence `x = v` is described by `x >= v` and `x <= v`.
+ */
+template <class Store>
+void branch_literals(const std::vector<std::pair<int, int>>& bounds, const Store& store, std::vector<BoundLiteral>& literals) {
+  for(size_t i = 0; i < bounds.size(); ++i) {
+    int lb = store[i].lb().value();
+    int ub = store[i].ub().value();
+    if(lb > bounds[i].first) {
+      literals.push_back({static_cast<int>(i), false, lb});
+    }
+    if(ub < bounds[i].second) {
+      literals.push_back({static_cast<int>(i), true, ub});
+    }
+  }
+}
+
+/** A database of nogoods, each nogood is a conjunction of bound literals which cannot be all satisfied.
+ * The literals of all the nogoods are stored contiguously in `literals`, and the two first literals of a nogood are its watched literals.
+ * Since the store does not notify the variables modified, `propagate` checks the two watched literals of each nogood, and only scans the other literals when a watched literal is entailed.
+ * A nogood only propagates when all its literals but one are entailed, the negation of the last literal is then told in the store.
+ */
+class NogoodDatabase {
+  std::vector<BoundLiteral> literals;
+  // The first literal and the size of each nogood.
+  std::vector<std::pair<size_t, size_t>> nogoods;
+
+  /** Replace the watched literal `w` of the nogood `[first, first+size)` by a literal not entailed, if any. */
+  template <class Store>
+  bool find_watch(const Store& store, size_t first, size_t size, size_t w) {
+    for(size_t i = first + 2; i < first + size; ++i) {
+      if(!literals[i].is_entailed(store)) {
+        std::swap(literals[first + w], literals[i]);
+        return true;
+      }
+    }
+    return false;
+  }
+
+public:
+  size_t size() const {
+    return nogoods.size();
+  }
+
+  void add(const std::vector<BoundLiteral>& nogood) {
+    if(nogood.empty()) {
+      return;
+    }
+    nogoods.emplace_back(literals.size(), nogood.size());
+    literals.insert(literals.end(), nogood.begin(), nogood.end());
+  }
+
+  /** Propagate all the nogoods once in `store`.
+   * \return The number of literals whose negation was told in `store`, the store becomes top if a nogood is entailed. */
+  template <class Store>
+  size_t propagate(Store& store) {
+    size_t num_tells = 0;
+    for(const auto& [first, size] : nogoods) {
+      if(store.is_top()) {
+        break;
+      }
+      if(size == 1) {
+        if(!literals[first].is_disentailed(store)) {
+          literals[first].tell_negation(store);
+          num_tells++;
+        }
+        continue;
+      }
+      if(literals[first].is_disentailed(store) || literals[first + 1].is_disentailed(store)) {
+        continue;
+      }
+      bool w0 = !literals[first].is_entailed(store) || find_watch(store, first, size, 0);
+      bool w1 = !literals[first + 1].is_entailed(store) || find_watch(store, first, size, 1);
+      if(w0 && w1) {
+        continue;
+      }
+      // The other literals are entailed: the nogood fails if both watched literals are entailed, otherwise the remaining watched literal must be false.
+      literals[first + (w0 ? 0 : 1)].tell_negation(store);
+      num_tells++;
+    }
+    return num_tells;
+  }
+};
+
+#endif
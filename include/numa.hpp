@@ -0,0 +1,283 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_NUMA_HPP
+#define TURBO_NUMA_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#ifdef TURBO_NUMA
+  #include <numa.h>
+#endif
+
+#include "common_solving.hpp"
+
+/** The NUMA nodes of the machine and the CPUs attached to each of them.
+ * Without libnuma (`TURBO_NUMA` undefined), all the CPUs are considered to be on a single node.
+ */
+class NumaTopology {
+  struct Node {
+    int id;
+    std::vector<int> cpus;
+  };
+  std::vector<Node> nodes;
+
+  NumaTopology() {
+#ifdef TURBO_NUMA
+    if(numa_available() != -1) {
+      std::vector<Node> all_nodes;
+      for(int i = 0; i <= numa_max_node(); ++i) {
+        all_nodes.push_back(Node{i, {}});
+      }
+      for(int cpu = 0; cpu < numa_num_configured_cpus(); ++cpu) {
+        int node = numa_node_of_cpu(cpu);
+        if(node >= 0 && numa_bitmask_isbitset(numa_all_cpus_ptr, cpu)) {
+          all_nodes[node].cpus.push_back(cpu);
+        }
+      }
+      // Some nodes only have memory and no CPU.
+      for(auto& node : all_nodes) {
+        if(!node.cpus.empty()) {
+          nodes.push_back(std::move(node));
+        }
+      }
+    }
+#endif
+    if(nodes.empty()) {
+      nodes.push_back(Node{0, {}});
+      int num_cpus = std::max(1u, std::thread::hardware_concurrency());
+      for(int cpu = 0; cpu < num_cpus; ++cpu) {
+        nodes[0].cpus.push_back(cpu);
+      }
+    }
+  }
+
+public:
+  static const NumaTopology& get() {
+    static NumaTopology topology;
+    return topology;
+  }
+
+  size_t num_nodes() const {
+    return nodes.size();
+  }
+
+  /** The workers are distributed in a round-robin fashion among the nodes, so all the memory controllers are used even with few workers. */
+  int node_of_worker(size_t idx) const {
+    return nodes[idx % nodes.size()].id;
+  }
+
+  int cpu_of_worker(size_t idx) const {
+    const auto& cpus = nodes[idx % nodes.size()].cpus;
+    return cpus[(idx / nodes.size()) % cpus.size()];
+  }
+
+  /** Pin the calling thread to the CPU of the worker `idx`.
+   * \return `false` if the thread could not be pinned (e.g. the CPU is not in the affinity mask of the process). */
+  bool pin_worker(size_t idx) const {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu_of_worker(idx), &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    return false;
+#endif
+  }
+};
+
+/** An arena of memory allocated on a single NUMA node, it is shared by all the allocators of one copy of the problem.
+ * Allocating directly with `numa_alloc_onnode` would cost a system call and a full page per allocation, and the propagators are mostly small objects.
+ * Instead, the small blocks are cut out of large chunks allocated on the node, and recycled in free lists (one per power of two from 16 to 4096 bytes).
+ * A mutex protects the arena, it is almost never contended since a copy of the problem is only used by its worker.
+ */
+class NumaArena {
+  static constexpr size_t min_block = 16;
+  static constexpr size_t max_block = 4096;
+  static constexpr size_t num_classes = 9;
+  static constexpr size_t chunk_bytes = size_t{1} << 20;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  int node;
+  std::mutex lock;
+  FreeBlock* free_lists[num_classes];
+  std::vector<unsigned char*> chunks;
+  unsigned char* chunk_top;
+  size_t chunk_left;
+
+  void* raw_allocate(size_t bytes) {
+#ifdef TURBO_NUMA
+    if(numa_available() != -1) {
+      return numa_alloc_onnode(bytes, node);
+    }
+#endif
+    return std::malloc(bytes);
+  }
+
+  void raw_deallocate(void* data, [[maybe_unused]] size_t bytes) {
+#ifdef TURBO_NUMA
+    if(numa_available() != -1) {
+      numa_free(data, bytes);
+      return;
+    }
+#endif
+    std::free(data);
+  }
+
+  static size_t size_class(size_t bytes) {
+    size_t c = 0;
+    while((min_block << c) < bytes) {
+      ++c;
+    }
+    return c;
+  }
+
+public:
+  NumaArena(int node)
+    : node(node)
+    , chunk_top(nullptr)
+    , chunk_left(0)
+  {
+    for(size_t i = 0; i < num_classes; ++i) {
+      free_lists[i] = nullptr;
+    }
+  }
+
+  NumaArena(const NumaArena&) = delete;
+
+  ~NumaArena() {
+    for(auto chunk : chunks) {
+      raw_deallocate(chunk, chunk_bytes);
+    }
+  }
+
+  int numa_node() const {
+    return node;
+  }
+
+  /** \return A block of at least `bytes` bytes (rounded to the size class of the block for small blocks). */
+  void* allocate(size_t& bytes) {
+    if(bytes > max_block) {
+      return raw_allocate(bytes);
+    }
+    size_t c = size_class(bytes);
+    bytes = min_block << c;
+    std::lock_guard<std::mutex> guard(lock);
+    if(free_lists[c] != nullptr) {
+      FreeBlock* block = free_lists[c];
+      free_lists[c] = block->next;
+      return block;
+    }
+    if(chunk_left < bytes) {
+      chunk_top = static_cast<unsigned char*>(raw_allocate(chunk_bytes));
+      if(chunk_top == nullptr) {
+        chunk_left = 0;
+        return nullptr;
+      }
+      chunks.push_back(chunk_top);
+      chunk_left = chunk_bytes;
+    }
+    void* block = chunk_top;
+    chunk_top += bytes;
+    chunk_left -= bytes;
+    return block;
+  }
+
+  void deallocate(void* data, size_t bytes) {
+    if(bytes > max_block) {
+      raw_deallocate(data, bytes);
+      return;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    FreeBlock* block = static_cast<FreeBlock*>(data);
+    size_t c = size_class(bytes);
+    block->next = free_lists[c];
+    free_lists[c] = block;
+  }
+};
+
+/** An allocator placing its memory on the NUMA node of its arena, to be used for the `BasicAllocator`, `PropAllocator` and `StoreAllocator` of a worker copy of the problem (see `NumaCP`).
+ * Each block starts with a header recording its arena and size, hence any `NumaAllocator` can deallocate a block, even a default constructed one (which uses `malloc`).
+ */
+class NumaAllocator {
+  struct alignas(16) Header {
+    NumaArena* arena;
+    size_t bytes;
+  };
+
+  std::shared_ptr<NumaArena> arena;
+
+public:
+  NumaAllocator() = default;
+  NumaAllocator(int node): arena(std::make_shared<NumaArena>(node)) {}
+  NumaAllocator(const NumaAllocator&) = default;
+  NumaAllocator& operator=(const NumaAllocator&) = default;
+
+  void* allocate(size_t bytes) {
+    if(bytes == 0) {
+      return nullptr;
+    }
+    size_t total = bytes + sizeof(Header);
+    void* block = arena ? arena->allocate(total) : std::malloc(total);
+    if(block == nullptr) {
+      return nullptr;
+    }
+    Header* header = static_cast<Header*>(block);
+    header->arena = arena.get();
+    header->bytes = total;
+    return header + 1;
+  }
+
+  void deallocate(void* data) {
+    if(data == nullptr) {
+      return;
+    }
+    Header* header = static_cast<Header*>(data) - 1;
+    if(header->arena != nullptr) {
+      header->arena->deallocate(header, header->bytes);
+    }
+    else {
+      std::free(header);
+    }
+  }
+
+  bool operator==(const NumaAllocator& other) const {
+    return arena == other.arena;
+  }
+};
+
+/** The copy of the problem used by a worker when `config.numa` is set. */
+using NumaCP = AbstractDomains<Itv,
+  NumaAllocator,
+  UniqueAlloc<NumaAllocator, 0>,
+  UniqueAlloc<NumaAllocator, 1>>;
+
+/** Create the copy of the problem of the worker `idx`, `args` being forwarded to the constructor of `WorkerCP` (e.g. `root` or `root.config`).
+ * When `WorkerCP` is `NumaCP`, all its memory is allocated on the NUMA node of the worker, the three allocators sharing one arena.
+ */
+template <class WorkerCP, class... Args>
+std::unique_ptr<WorkerCP> make_worker_cp(size_t idx, const Args&... args) {
+  if constexpr(std::is_same_v<WorkerCP, NumaCP>) {
+    NumaAllocator alloc(NumaTopology::get().node_of_worker(idx));
+    return std::make_unique<WorkerCP>(args..., alloc,
+      UniqueAlloc<NumaAllocator, 0>(alloc),
+      UniqueAlloc<NumaAllocator, 1>(alloc));
+  }
+  else {
+    return std::make_unique<WorkerCP>(args...);
+  }
+}
+
+#endif
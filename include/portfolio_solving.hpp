@@ -0,0 +1,97 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_PORTFOLIO_SOLVING_HPP
+#define TURBO_PORTFOLIO_SOLVING_HPP
+
+#include <memory>
+#include <mutex>
+
+#include "common_solving.hpp"
+#include "cpu_parallel.hpp"
+
+/** The variable and value orderings given to the copies of the portfolio.
+ * The copy `i` uses `portfolio_var_orders[i % 5]` and `portfolio_val_orders[(i / 5) % 4]`, and the variables are shuffled with the seed `i / 20` (no shuffling for the first 20 copies).
+ * The copy `0` is the one we would run sequentially: it keeps the search annotations of the model, and uses `first_fail, indomain_min` otherwise.
+ */
+static const char* portfolio_var_orders[] = {"first_fail", "input_order", "anti_first_fail", "smallest", "largest"};
+static const char* portfolio_val_orders[] = {"indomain_min", "indomain_max", "indomain_split", "indomain_reverse_split"};
+
+template <class WorkerCP>
+struct PortfolioWorker {
+  using cp_type = WorkerCP;
+  size_t idx;
+  const char* var_order;
+  const char* val_order;
+  unsigned int seed;
+  GaussSeidelIteration fp_engine;
+  std::unique_ptr<WorkerCP> cp;
+
+  /** The abstract domains are only interpreted when the thread starts (see `interpret`), so the copies are built in parallel. */
+  PortfolioWorker(size_t idx, const CP<Itv>& root)
+    : idx(idx)
+    , var_order(portfolio_var_orders[idx % 5])
+    , val_order(portfolio_val_orders[(idx / 5) % 4])
+    , seed(static_cast<unsigned int>(idx / 20))
+    , cp(make_worker_cp<WorkerCP>(idx, root.config))
+  {
+    // The interpretation of the model is already logged by `root`.
+    cp->config.verbose_solving = false;
+    cp->config.print_ast = false;
+  }
+
+  size_t depth() const {
+    return cp->search_tree->depth();
+  }
+
+  template <class F>
+  void interpret(F& f) {
+    cp->interpret_variant(f, idx != 0, var_order, val_order, seed);
+  }
+};
+
+template <class WorkerCP>
+struct PortfolioData : public ParallelData<PortfolioWorker<WorkerCP>> {
+  using F = TFormula<typename CP<Itv>::basic_allocator_type>;
+  // One copy of the formula per worker, since the interpretation modifies the formula (e.g. typing).
+  std::vector<F> formulas;
+
+  PortfolioData(CP<Itv>& root, const F& formula)
+    : ParallelData<PortfolioWorker<WorkerCP>>(root, root.config.portfolio)
+    , formulas(root.config.portfolio, formula)
+  {}
+};
+
+/** Each worker runs a sequential depth-first search with its own strategy, and shares its solutions and the best bound with the other workers.
+ * The first worker exploring its whole search tree proves optimality (or unsatisfiability), and stops all the others. */
+template <class WorkerCP>
+void cpu_portfolio_worker(ParallelData<PortfolioWorker<WorkerCP>>& parallel_data, size_t worker_idx) {
+  auto& data = static_cast<PortfolioData<WorkerCP>&>(parallel_data);
+  auto& w = data.workers[worker_idx];
+  w.interpret(data.formulas[worker_idx]);
+  WorkerCP& cp = *w.cp;
+  local::BInc has_changed = true;
+  while(has_changed && !data.stop) {
+    has_changed = false;
+    update_worker_best_bound(w, data);
+    propagate(w, data, has_changed);
+    cp.search_tree->refine(has_changed);
+  }
+  if(!has_changed && !data.stop.exchange(true) && data.root.config.verbose_solving) {
+    std::lock_guard<std::mutex> lock(data.print_lock);
+    printf("%% Portfolio worker %zu (%s, %s, seed %u) completed its search first.\n", worker_idx, w.var_order, w.val_order, w.seed);
+  }
+}
+
+/** Run `config.portfolio` copies of the problem, each with a different search strategy, concurrently on CPU threads.
+ * `formula` is the formula interpreted in `root` by `preprocess`.
+ * It cannot be used to enumerate several solutions of a satisfaction problem, since the copies would report the same solutions. */
+template <class WorkerCP, class FormulaPtr, class Timepoint>
+void cpu_portfolio_solve(CP<Itv>& root, const FormulaPtr& formula, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving with a portfolio of %zu solvers.\n", root.config.portfolio);
+  }
+  auto data = std::make_unique<PortfolioData<WorkerCP>>(root, *formula);
+  run_parallel<PortfolioWorker<WorkerCP>>(*data, cpu_portfolio_worker<WorkerCP>, start);
+}
+
+#endif
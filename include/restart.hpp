@@ -0,0 +1,51 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_RESTART_HPP
+#define TURBO_RESTART_HPP
+
+#include <cmath>
+
+#include "config.hpp"
+
+/** The failure limits of the successive runs of a restart-based search.
+ * The limit of the run `i` (starting at 1) is `base * luby(i)` with `RestartStrategy::LUBY`, and `base * RESTART_GEOMETRIC_FACTOR^(i-1)` with `RestartStrategy::GEOMETRIC`.
+ */
+class RestartSchedule {
+  RestartStrategy strategy;
+  size_t base;
+  size_t run;
+  double geometric_limit;
+
+public:
+  RestartSchedule(RestartStrategy strategy, size_t base)
+    : strategy(strategy)
+    , base(base == 0 ? 1 : base)
+    , run(0)
+    , geometric_limit(static_cast<double>(this->base))
+  {}
+
+  /** The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ... (`i >= 1`). */
+  static size_t luby(size_t i) {
+    size_t k = 1;
+    while((size_t{1} << k) - 1 < i) {
+      ++k;
+    }
+    if(i == (size_t{1} << k) - 1) {
+      return size_t{1} << (k - 1);
+    }
+    return luby(i - (size_t{1} << (k - 1)) + 1);
+  }
+
+  /** The number of failures allowed in the next run. */
+  size_t next_limit() {
+    ++run;
+    if(strategy == RestartStrategy::LUBY) {
+      return base * luby(run);
+    }
+    size_t limit = static_cast<size_t>(std::ceil(geometric_limit));
+    geometric_limit *= RESTART_GEOMETRIC_FACTOR;
+    return limit;
+  }
+};
+
+#endif
@@ -3,11 +3,15 @@
 #ifndef TURBO_STATISTICS_HPP
 #define TURBO_STATISTICS_HPP
 
+#include <atomic>
 #include <chrono>
 #include <algorithm>
+#include <cstdint>
+#include <new>
 #include "battery/utility.hpp"
 #include "battery/allocator.hpp"
 #include "lala/logic/ast.hpp"
+#include "config.hpp"
 
 struct Statistics {
   size_t variables;
@@ -23,6 +27,20 @@ struct Statistics {
   size_t eps_num_subproblems;
   size_t eps_solved_subproblems;
   size_t eps_skipped_subproblems;
+  size_t eps_reused_dive_nodes; // Nodes of a dive not propagated again thanks to the previous dive (CPU only).
+  size_t eps_saved_fixpoint_iterations; // Fixpoint iterations of these nodes.
+  size_t eps_pruned_subproblems; // Subproblems discarded by their bound before being solved (bound-ordered EPS).
+  size_t restarts;
+  size_t nogoods; // Nogoods recorded at the restarts.
+  size_t nogood_prunings; // Bounds told by the nogoods.
+  size_t learned_nogoods;
+  size_t backjumped_levels; // Decisions skipped by the backjumps, compared to chronological backtracking.
+  size_t conflict_checks; // Fixpoints computed to explain the failures.
+  size_t guided_decisions; // Decisions on the value of the best solution.
+  size_t lns_neighbourhoods;
+  size_t lns_improvements; // Neighbourhoods in which a better solution was found.
+  size_t dichotomic_probes;
+  size_t dichotomic_refuted_halves; // Probes proving that the optimum is in the other half of the gap.
   size_t num_blocks_done;
   size_t fixpoint_iterations;
   size_t eliminated_variables;
@@ -35,8 +53,9 @@ struct Statistics {
     duration(0), interpretation_duration(0),
     nodes(0), fails(0), solutions(0),
     depth_max(0), exhaustive(true),
-    eps_solved_subproblems(0), eps_num_subproblems(1), eps_skipped_subproblems(0),
-    num_blocks_done(0), fixpoint_iterations(0),
+    eps_num_subproblems(1), eps_solved_subproblems(0), eps_skipped_subproblems(0),
+    eps_reused_dive_nodes(0), eps_saved_fixpoint_iterations(0), eps_pruned_subproblems(0),
+    restarts(0), nogoods(0), nogood_prunings(0), learned_nogoods(0), backjumped_levels(0), conflict_checks(0), guided_decisions(0), lns_neighbourhoods(0), lns_improvements(0), dichotomic_probes(0), dichotomic_refuted_halves(0), num_blocks_done(0), fixpoint_iterations(0),
     eliminated_variables(0), eliminated_formulas(0),
     search_time(0.0), propagation_time(0.0)
     {}
@@ -55,6 +74,20 @@ struct Statistics {
     exhaustive = exhaustive && other.exhaustive;
     eps_solved_subproblems += other.eps_solved_subproblems;
     eps_skipped_subproblems += other.eps_skipped_subproblems;
+    eps_pruned_subproblems += other.eps_pruned_subproblems;
+    eps_reused_dive_nodes += other.eps_reused_dive_nodes;
+    eps_saved_fixpoint_iterations += other.eps_saved_fixpoint_iterations;
+    restarts += other.restarts;
+    nogoods += other.nogoods;
+    nogood_prunings += other.nogood_prunings;
+    learned_nogoods += other.learned_nogoods;
+    backjumped_levels += other.backjumped_levels;
+    conflict_checks += other.conflict_checks;
+    guided_decisions += other.guided_decisions;
+    lns_neighbourhoods += other.lns_neighbourhoods;
+    lns_improvements += other.lns_improvements;
+    dichotomic_probes += other.dichotomic_probes;
+    dichotomic_refuted_halves += other.dichotomic_refuted_halves;
     num_blocks_done += other.num_blocks_done;
     fixpoint_iterations += other.fixpoint_iterations;
     search_time += other.search_time;
@@ -75,7 +108,9 @@ private:
   }
 
 public:
-  CUDA void print_mzn_statistics() const {
+  /** The counters of the CPU modes are only printed when the mode is enabled in `config`. */
+  template <class Alloc>
+  CUDA void print_mzn_statistics(const Configuration<Alloc>& config) const {
     print_stat("nodes", nodes);
     print_stat("failures", fails);
     print_stat("variables", variables);
@@ -87,6 +122,38 @@ public:
     print_stat("eps_num_subproblems", eps_num_subproblems);
     print_stat("eps_solved_subproblems", eps_solved_subproblems);
     print_stat("eps_skipped_subproblems", eps_skipped_subproblems);
+    if(config.bound_ordered_eps) {
+      print_stat("eps_pruned_subproblems", eps_pruned_subproblems);
+    }
+    if(config.arch == Arch::CPU && config.or_nodes > 1) {
+      print_stat("eps_reused_dive_nodes", eps_reused_dive_nodes);
+      print_stat("eps_saved_fixpoint_iterations", eps_saved_fixpoint_iterations);
+    }
+    if(config.restart != RestartStrategy::NONE) {
+      print_stat("restarts", restarts);
+    }
+    if(config.nogoods) {
+      print_stat("nogoods", nogoods);
+    }
+    if(config.nogoods || config.learning) {
+      print_stat("nogood_prunings", nogood_prunings);
+    }
+    if(config.learning) {
+      print_stat("learned_nogoods", learned_nogoods);
+      print_stat("backjumped_levels", backjumped_levels);
+      print_stat("conflict_checks", conflict_checks);
+    }
+    if(config.solution_guided) {
+      print_stat("guided_decisions", guided_decisions);
+    }
+    if(config.lns != 0) {
+      print_stat("lns_neighbourhoods", lns_neighbourhoods);
+      print_stat("lns_improvements", lns_improvements);
+    }
+    if(config.dichotomic != 0) {
+      print_stat("dichotomic_probes", dichotomic_probes);
+      print_stat("dichotomic_refuted_halves", dichotomic_refuted_halves);
+    }
     print_stat("num_blocks_done", num_blocks_done);
     print_stat("fixpoint_iterations", fixpoint_iterations);
     print_stat("eliminated_variables", eliminated_variables);
@@ -137,4 +204,97 @@ public:
   }
 };
 
+/** Store `v` in `x` which is read concurrently by other threads (see `LiveStatistics`). */
+CUDA inline void relaxed_store(size_t& x, size_t v) {
+#ifdef __CUDA_ARCH__
+  *static_cast<volatile size_t*>(&x) = v;
+#else
+  std::atomic_ref<size_t>(x).store(v, std::memory_order_relaxed);
+#endif
+}
+
+inline size_t relaxed_load(const size_t& x) {
+  return std::atomic_ref<size_t>(const_cast<size_t&>(x)).load(std::memory_order_relaxed);
+}
+
+/** The counters of a thread that can be read while it is solving (see `StatisticsRegistry`).
+ * They are only written by their thread, which publishes its `Statistics` in each node.
+ * Each slot is alone on its cache line, so the threads do not slow down each other by writing their counters (false sharing).
+ */
+struct alignas(64) LiveStatistics {
+  size_t nodes;
+  size_t fails;
+  size_t solutions;
+  size_t depth_max;
+
+  CUDA LiveStatistics(): nodes(0), fails(0), solutions(0), depth_max(0) {}
+
+  CUDA void publish(const Statistics& stats) {
+    relaxed_store(nodes, stats.nodes);
+    relaxed_store(fails, stats.fails);
+    relaxed_store(solutions, stats.solutions);
+    relaxed_store(depth_max, stats.depth_max);
+  }
+};
+
+/** One `LiveStatistics` per thread, allocated with `Allocator` (e.g. in managed memory on GPU so the CPU can read the counters of the blocks).
+ * The counters can be summed at any time without lock and without stopping the threads.
+ * Since the threads are not stopped, the sum is not an exact snapshot of the search, but each counter is exact up to the last node of each thread.
+ * The final statistics are still reduced with `Statistics::join`.
+ */
+template <class Allocator>
+class StatisticsRegistry {
+  Allocator allocator;
+  void* memory;
+  LiveStatistics* slots;
+  size_t n;
+
+public:
+  CUDA StatisticsRegistry(size_t num_threads, const Allocator& alloc = Allocator())
+    : allocator(alloc)
+    , n(num_threads)
+  {
+    // The allocator might not respect the alignment of `LiveStatistics`, hence we align the slots ourselves.
+    memory = allocator.allocate((n + 1) * sizeof(LiveStatistics));
+    uintptr_t p = reinterpret_cast<uintptr_t>(memory);
+    p = (p + alignof(LiveStatistics) - 1) & ~static_cast<uintptr_t>(alignof(LiveStatistics) - 1);
+    slots = reinterpret_cast<LiveStatistics*>(p);
+    for(size_t i = 0; i < n; ++i) {
+      new(&slots[i]) LiveStatistics();
+    }
+  }
+
+  StatisticsRegistry(const StatisticsRegistry&) = delete;
+
+  CUDA ~StatisticsRegistry() {
+    allocator.deallocate(memory);
+  }
+
+  CUDA size_t size() const {
+    return n;
+  }
+
+  CUDA LiveStatistics* slot(size_t i) {
+    return &slots[i];
+  }
+
+  /** The sum of the counters of all the threads (`depth_max` is the maximum). */
+  LiveStatistics sum() const {
+    LiveStatistics total;
+    for(size_t i = 0; i < n; ++i) {
+      total.nodes += relaxed_load(slots[i].nodes);
+      total.fails += relaxed_load(slots[i].fails);
+      total.solutions += relaxed_load(slots[i].solutions);
+      total.depth_max = std::max(total.depth_max, relaxed_load(slots[i].depth_max));
+    }
+    return total;
+  }
+
+  void print(int64_t duration_ms) const {
+    LiveStatistics total = sum();
+    printf("%% %.1fs: nodes=%zu, failures=%zu, solutions=%zu, peakDepth=%zu\n",
+      static_cast<double>(duration_ms) / 1000., total.nodes, total.fails, total.solutions, total.depth_max);
+  }
+};
+
 #endif
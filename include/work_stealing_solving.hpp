@@ -0,0 +1,183 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_WORK_STEALING_SOLVING_HPP
+#define TURBO_WORK_STEALING_SOLVING_HPP
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "common_solving.hpp"
+#include "cpu_parallel.hpp"
+
+/** A worker of the work-stealing search engine.
+ * Instead of relying on `search_tree`, the worker explores the tree in depth-first order by itself, and keeps the open nodes (the right branches not yet explored) in a deque of snapshots of `ipc`.
+ * The owner pushes and pops the deepest nodes at the back, while the thieves steal the shallowest nodes at the front, which are likely to root the largest subtrees.
+ * The split strategies only produce constraints on the domain of the variables, hence a snapshot taken in one copy of the problem can be restored in another copy.
+ */
+template <class WorkerCP>
+struct StealingWorker {
+  using cp_type = WorkerCP;
+  using snapshot_type = typename WorkerCP::IPC::template snapshot_type<bt::standard_allocator>;
+
+  struct OpenNode {
+    snapshot_type snapshot;
+    size_t depth;
+  };
+
+  size_t idx;
+  GaussSeidelIteration fp_engine;
+  std::unique_ptr<WorkerCP> cp;
+  size_t current_depth;
+  std::mutex open_nodes_lock;
+  std::deque<OpenNode> open_nodes;
+  size_t steals;
+
+  StealingWorker(size_t idx, const CP<Itv>& root)
+    : idx(idx)
+    , cp(make_worker_cp<WorkerCP>(idx, root))
+    , current_depth(0)
+    , steals(0)
+  {}
+
+  size_t depth() const {
+    return current_depth;
+  }
+
+  void push_deepest(OpenNode&& node) {
+    std::lock_guard<std::mutex> lock(open_nodes_lock);
+    open_nodes.push_back(std::move(node));
+  }
+
+  bool pop_deepest(std::unique_ptr<OpenNode>& node) {
+    std::lock_guard<std::mutex> lock(open_nodes_lock);
+    if(open_nodes.empty()) {
+      return false;
+    }
+    node = std::make_unique<OpenNode>(std::move(open_nodes.back()));
+    open_nodes.pop_back();
+    return true;
+  }
+
+  bool steal_shallowest(std::unique_ptr<OpenNode>& node) {
+    std::lock_guard<std::mutex> lock(open_nodes_lock);
+    if(open_nodes.empty()) {
+      return false;
+    }
+    node = std::make_unique<OpenNode>(std::move(open_nodes.front()));
+    open_nodes.pop_front();
+    return true;
+  }
+
+  /** Load `node` in `cp`.
+   * The split strategy is reset because the variables it already skipped might not be assigned in `node`. */
+  void restore(const OpenNode& node) {
+    cp->ipc->restore(node.snapshot);
+    cp->split->reset();
+    current_depth = node.depth;
+  }
+};
+
+template <class WorkerCP>
+struct WorkStealingData : public ParallelData<StealingWorker<WorkerCP>> {
+  // Number of workers currently owning an open node or exploring a node, the search terminates when it reaches 0.
+  std::atomic<size_t> busy_workers;
+
+  WorkStealingData(CP<Itv>& root)
+    : ParallelData<StealingWorker<WorkerCP>>(root, root.config.or_nodes)
+    , busy_workers(1)
+  {}
+};
+
+/** Try to steal the shallowest open node of another worker, starting from the next worker in a round-robin fashion.
+ * To detect termination, a thief announces itself busy before stealing, so `busy_workers` only reaches 0 when no open node is left. */
+template <class WorkerCP>
+bool steal(StealingWorker<WorkerCP>& w, WorkStealingData<WorkerCP>& data, std::unique_ptr<typename StealingWorker<WorkerCP>::OpenNode>& node) {
+  size_t n = data.workers.size();
+  data.busy_workers += 1;
+  for(size_t i = 1; i < n; ++i) {
+    if(data.workers[(w.idx + i) % n].steal_shallowest(node)) {
+      w.steals++;
+      return true;
+    }
+  }
+  data.busy_workers -= 1;
+  return false;
+}
+
+/** Split the current node, push all its children except the left most one in the deque, and enter the left most child.
+ * \return `false` if there is nothing left to split, the node is then a leaf. */
+template <class WorkerCP>
+bool branch(StealingWorker<WorkerCP>& w) {
+  WorkerCP& cp = *w.cp;
+  auto branches = cp.split->split();
+  if(branches.size() == 0) {
+    return false;
+  }
+  auto parent = cp.ipc->template snapshot<bt::standard_allocator>();
+  for(int i = branches.size() - 1; i > 0; --i) {
+    cp.ipc->restore(parent);
+    cp.ipc->tell(branches[i]);
+    w.push_deepest({cp.ipc->template snapshot<bt::standard_allocator>(), w.current_depth + 1});
+  }
+  cp.ipc->restore(parent);
+  cp.ipc->tell(branches[0]);
+  w.current_depth++;
+  return true;
+}
+
+/** The function executed by each thread: a depth-first search where the worker steals work when its own deque is empty.
+ * Worker 0 starts with the root node, the others start by stealing. */
+template <class WorkerCP>
+void cpu_work_stealing_worker(ParallelData<StealingWorker<WorkerCP>>& parallel_data, size_t worker_idx) {
+  auto& data = static_cast<WorkStealingData<WorkerCP>&>(parallel_data);
+  auto& w = data.workers[worker_idx];
+  std::unique_ptr<typename StealingWorker<WorkerCP>::OpenNode> node;
+  bool has_node = (worker_idx == 0);
+  while(!data.stop) {
+    if(!has_node) {
+      if(steal(w, data, node)) {
+        w.restore(*node);
+        has_node = true;
+      }
+      else if(data.busy_workers == 0) {
+        break;
+      }
+      else {
+        std::this_thread::yield();
+        continue;
+      }
+    }
+    local::BInc has_changed;
+    update_worker_best_bound(w, data);
+    if(propagate(w, data, has_changed) || !branch(w)) {
+      // The owner becomes idle only when its deque is empty, since no other worker can push in it.
+      if(w.pop_deepest(node)) {
+        w.restore(*node);
+      }
+      else {
+        has_node = false;
+        data.busy_workers -= 1;
+      }
+    }
+  }
+}
+
+/** Parallel depth-first search with work stealing on `config.or_nodes` threads. */
+template <class WorkerCP, class Timepoint>
+void cpu_work_stealing_solve(CP<Itv>& root, const Timepoint& start) {
+  if(root.config.verbose_solving) {
+    printf("%% Solving with %zu threads and work stealing.\n", root.config.or_nodes);
+  }
+  auto data = std::make_unique<WorkStealingData<WorkerCP>>(root);
+  run_parallel<StealingWorker<WorkerCP>>(*data, cpu_work_stealing_worker<WorkerCP>, start);
+  if(root.config.verbose_solving) {
+    size_t steals = 0;
+    for(const auto& w : data->workers) {
+      steals += w.steals;
+    }
+    printf("%% Number of steals: %zu\n", steals);
+  }
+}
+
+#endif
@@ -9,7 +9,7 @@
 #include <algorithm>
 
 void usage_and_exit(const std::string& program_name) {
-  std::cout << "usage: " << program_name << " [-t 2000] [-a] [-n 10] [-i] [-f] [-s] [-v] [-p <i>] [-arch <cpu|gpu>] [-p 48] [-or 48] [-and 256] [-sub 12] [-heap 100] [-stack 100] [-version 1.0.0] [xcsp3instance.xml | fzninstance.fzn]" << std::endl;
+  std::cout << "usage: " << program_name << " [-t 2000] [-a] [-n 10] [-i] [-f] [-s] [-v] [-p <i>] [-arch <cpu|gpu>] [-p 48] [-or 48] [-and 256] [-sub 12] [-ws] [-portfolio 8] [-numa] [-deterministic] [-adaptive] [-bound-order] [-frontier] [-interleave 4] [-coordinator 4000] [-connect 127.0.0.1:4000] [-restart <luby|geometric>] [-restart-base 100] [-nogoods] [-learn] [-var-order <dom_w_deg|activity>] [-solution-guided] [-lns 200] [-dichotomic 1000] [-heap 100] [-stack 100] [-version 1.0.0] [xcsp3instance.xml | fzninstance.fzn]" << std::endl;
   std::cout << "\t-t 2000: Run the solver with a timeout of 2000 milliseconds." << std::endl;
   std::cout << "\t-timeout 2000: Same as -t, but if both -t and -timeout are specified, -timeout overrides -t." << std::endl;
   std::cout << "\t-a: Instructs the solver to report all solutions in the case of satisfaction problems, or print intermediate solutions of increasing quality in the case of optimisation problems." << std::endl;
@@ -19,11 +19,30 @@ void usage_and_exit(const std::string& program_name) {
   std::cout << "\t-s: Print statistics during and after the search for solutions." << std::endl;
   std::cout << "\t-v: Print log messages (verbose solving) to the standard error stream." << std::endl;
   std::cout << "\t-ast: Print the AST of the model (useful to debug)." << std::endl;
-  std::cout << "\t-p 48: On CPU, run with 48 parallel threads. On GPU, equivalent to `-or 48`." << std::endl;
+  std::cout << "\t-p 48: On CPU, run with 48 parallel threads solving the subproblems in turns (embarrasingly parallel search). Default: sequential solving. With -p 0, the number of threads and the number of subproblems (-sub) are chosen from the available cores (affinity mask and cgroup quota) and a short calibration of the propagation cost after preprocessing. On GPU, equivalent to `-or 48`." << std::endl;
   std::cout << "\t-arch <cpu|gpu>: Choose the architecture on which the problem will be solved." << std::endl;
   std::cout << "\t-or 48: Run the subproblems on 48 streaming multiprocessors (SMs) (only for GPU architecture). Default: -or 0 for automatic selection of the number of SMs." << std::endl;
-  std::cout << "\t-and 256: Run each subproblem with 256 threads per block (only for GPU architecture). Default: -and 0 for automatic selection of the number of threads per block." << std::endl;
-  std::cout << "\t-sub 12: Create 2^12 subproblems to be solved in turns by the 'OR threads' (embarrasingly parallel search). Default: -sub 10." << std::endl;
+  std::cout << "\t-and 256: Run each subproblem with 256 threads per block. On CPU, propagate with 256 threads when solving sequentially (without -p or with -p 1). Default: -and 0 for automatic selection of the number of threads per block on GPU, and for a single propagation thread on CPU." << std::endl;
+  std::cout << "\t-sub 12: Create 2^12 subproblems to be solved in turns by the 'OR threads' (embarrasingly parallel search). On CPU, it is only used when -p is greater than 1. Default: -sub 12." << std::endl;
+  std::cout << "\t-ws: On CPU, the threads explore the search tree in depth-first order and steal the shallowest open nodes of the other threads when they are idle, instead of solving the EPS subproblems (only used when -p is greater than 1)." << std::endl;
+  std::cout << "\t-portfolio 8: On CPU, run 8 copies of the problem in parallel, each with a different search strategy, and stop as soon as one of them completes its search. The copies share their best solutions." << std::endl;
+  std::cout << "\t-numa: On CPU, pin each thread to a core and allocate its copy of the problem on the NUMA node of this core (only used with -p greater than 1 or -portfolio; the memory placement requires Turbo to be compiled with -DWITH_NUMA=ON)." << std::endl;
+  std::cout << "\t-deterministic: On CPU, the threads solve the EPS subproblems in a fixed order and share their solutions at synchronization points every " << DETERMINISTIC_EPOCH_NODES << " nodes, so two runs with the same -p explore the same search tree (only used when -p is greater than 1, and takes precedence over -ws and -portfolio)." << std::endl;
+  std::cout << "\t-adaptive: On CPU, start EPS with 2^N subproblems (given by -sub N), and then split the remaining subproblems deeper or coarser according to the time spent diving and solving the previous ones (only used when -p is greater than 1, and ignored with -deterministic)." << std::endl;
+  std::cout << "\t-bound-order: On CPU and for optimisation problems, propagate all the EPS subproblems first, and solve them in the order of the bound of their objective; the subproblems that cannot improve the best solution are pruned without being solved (only used when -p is greater than 1)." << std::endl;
+  std::cout << "\t-frontier: On CPU, generate and propagate the EPS subproblems once, in parallel, before solving them; the failed subproblems are discarded and the others are loaded directly instead of diving from the root (only used when -p is greater than 1)." << std::endl;
+  std::cout << "\t-interleave 4: On CPU, each thread explores 4 EPS subproblems in turns, " << INTERLEAVE_SLICE_NODES << " nodes at a time, instead of solving them one after the other (only used when -p is greater than 1)." << std::endl;
+  std::cout << "\t-restart luby: On CPU and when solving sequentially, restart the search from the root when the number of failures since the last restart reaches the limit given by the Luby sequence (1, 1, 2, 1, 1, 2, 4, ...) or by a geometric sequence (`-restart geometric`, multiplied by " << RESTART_GEOMETRIC_FACTOR << " at each restart), times -restart-base. The best solution is kept across restarts. The search strategy of the model takes the same decisions after each restart, hence -restart is only useful with -nogoods or -var-order." << std::endl;
+  std::cout << "\t-restart-base 100: The number of failures before the first restart (see -restart). Default: -restart-base " << RESTART_BASE << "." << std::endl;
+  std::cout << "\t-nogoods: With -restart, record the parts of the search tree refuted before each restart as nogoods, which are propagated in the following runs so these parts are not explored again." << std::endl;
+  std::cout << "\t-learn: On CPU and when solving sequentially, explain each failure by a minimal subset of the decisions of the branch (computed by deletion, since the propagators do not explain their deductions as in lazy clause generation), record it as a nogood and backjump to the deepest decision of this subset (-restart is ignored)." << std::endl;
+  std::cout << "\t-var-order dom_w_deg: On CPU and when solving sequentially, branch on the variable with the smallest ratio between its domain size and the number of failures caused by its constraints, on its lower bound first (it replaces the orders of the search annotations of the model as with -f, but first branches on their variables, and the propagation is not parallelized with -and)." << std::endl;
+  std::cout << "\t-var-order activity: Same as above, but branch on the variable with the largest ratio between its activity and its domain size, the activity of a variable being the number of nodes where its domain was narrowed by the propagation, decayed by " << ACTIVITY_DECAY << " at each node." << std::endl;
+  std::cout << "\t-dichotomic 1000: On CPU, when solving an optimisation problem sequentially, alternate after the first solution between runs of at most 1000 failures constraining the objective to the better half of the gap between its proven bound and the best solution, and runs of branch and bound of at most 1000 failures. Default: -dichotomic 0 (disabled)." << std::endl;
+  std::cout << "\t-solution-guided: On CPU, when solving an optimisation problem sequentially, try the value of the variable in the best solution first, and then the values below and above it (with -var-order, or with the variables selected by the search strategy of the model)." << std::endl;
+  std::cout << "\t-lns 200: On CPU, when solving an optimisation problem sequentially, use a large neighbourhood search after the first solution: each neighbourhood fixes a part of the decision variables to their value in the best solution, and searches the other variables for a better solution until 200 failures. The search is not complete, hence optimality is only proven if a neighbourhood fixing no variable is exhausted, and the search usually only stops with -t or CTRL-C (without printing ==========). Default: -lns 0 (disabled)." << std::endl;
+  std::cout << "\t-coordinator 4000: On CPU, distribute the EPS subproblems to the workers connecting on the TCP port 4000, by ranges of " << DISTRIBUTED_RANGE_SIZE << " subproblems. The coordinator collects the solutions and the statistics of the workers but does not solve any subproblem itself. The subproblems of a worker disconnecting before the end are given to the other workers. Without -t, the coordinator waits for the workers as long as subproblems are left, but stops if no worker connects during the first " << DISTRIBUTED_CONNECT_TIMEOUT_MS / 1000 << " seconds." << std::endl;
+  std::cout << "\t-connect 127.0.0.1:4000: On CPU, solve the EPS subproblems of the coordinator listening on 127.0.0.1:4000 with -p threads. The coordinator and its workers must be run on the same problem with the same -sub." << std::endl;
   std::cout << "\t-stack 100: Use a maximum of 100KB of stack size per thread stored in global memory (only for GPU architectures)." << std::endl;
   std::cout << "\t-version 1.0.0: A version identifier that is printed as statistics to know which version of Turbo was used to solve an instance. It is only for documentation and replicability purposes." << std::endl;
   std::cout << "\t-hardware \"Intel Core i9-10900X@3.7GHz;24GO DDR4;NVIDIA RTX A5000\": The description of the hardware on which the solver is executed (\"CPU;RAM;GPU\"). It is only for documentation and replicability purposes." << std::endl;
@@ -118,10 +137,18 @@ Configuration<battery::standard_allocator> parse_args(int argc, char** argv) {
     std::cerr << "The options -or and -p cannot be used at the same time" << std::endl;
     usage_and_exit(argv[0]);
   }
-  input.read_size_t("-p", config.or_nodes);
+  if(input.read_size_t("-p", config.or_nodes) && config.or_nodes == 0) {
+    config.auto_threads = true;
+  }
   input.read_size_t("-or", config.or_nodes);
   input.read_size_t("-and", config.and_nodes);
   input.read_size_t("-sub", config.subproblems_power);
+  input.read_size_t("-portfolio", config.portfolio);
+  input.read_size_t("-interleave", config.interleave);
+  input.read_size_t("-coordinator", config.coordinator_port);
+  input.read_size_t("-restart-base", config.restart_base);
+  input.read_size_t("-lns", config.lns);
+  input.read_size_t("-dichotomic", config.dichotomic);
   input.read_size_t("-t", config.timeout_ms);
   input.read_size_t("-timeout", config.timeout_ms);
   input.read_size_t("-stack", config.stack_kb);
@@ -142,6 +169,15 @@ Configuration<battery::standard_allocator> parse_args(int argc, char** argv) {
   input.read_bool("-s", config.print_statistics);
   input.read_bool("-globalmem", config.only_global_memory);
   input.read_bool("-noatomics", config.noatomics);
+  input.read_bool("-ws", config.work_stealing);
+  input.read_bool("-numa", config.numa);
+  input.read_bool("-nogoods", config.nogoods);
+  input.read_bool("-learn", config.learning);
+  input.read_bool("-solution-guided", config.solution_guided);
+  input.read_bool("-deterministic", config.deterministic);
+  input.read_bool("-adaptive", config.adaptive_eps);
+  input.read_bool("-bound-order", config.bound_ordered_eps);
+  input.read_bool("-frontier", config.eps_frontier);
 
   std::string architecture;
   if(input.read_string("-arch", architecture)) {
@@ -156,6 +192,32 @@ Configuration<battery::standard_allocator> parse_args(int argc, char** argv) {
       exit(EXIT_FAILURE);
     }
   }
+  std::string restart;
+  if(input.read_string("-restart", restart)) {
+    if(restart == "luby") {
+      config.restart = RestartStrategy::LUBY;
+    }
+    else if(restart == "geometric") {
+      config.restart = RestartStrategy::GEOMETRIC;
+    }
+    else {
+      std::cerr << "Unknown restart strategy -restart " << restart << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  std::string var_order;
+  if(input.read_string("-var-order", var_order)) {
+    if(var_order == "dom_w_deg") {
+      config.var_order = VarOrder::DOM_WDEG;
+    }
+    else if(var_order == "activity") {
+      config.var_order = VarOrder::ACTIVITY;
+    }
+    else {
+      std::cerr << "Unknown variable order -var-order " << var_order << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
   std::string version;
   if(input.read_string("-version", version)) {
     config.version = battery::string<battery::standard_allocator>(version.data());
@@ -164,6 +226,10 @@ Configuration<battery::standard_allocator> parse_args(int argc, char** argv) {
   if(input.read_string("-hardware", hardware)) {
     config.hardware = battery::string<battery::standard_allocator>(hardware.data());
   }
+  std::string connect_to;
+  if(input.read_string("-connect", connect_to)) {
+    config.connect_to = battery::string<battery::standard_allocator>(connect_to.data());
+  }
   std::string problem_path;
   input.read_input_file(problem_path);
   config.problem_path = battery::string<battery::standard_allocator>(problem_path.data());
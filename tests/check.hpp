@@ -0,0 +1,18 @@
+// Copyright 2023 Pierre Talbot
+
+#ifndef TURBO_TESTS_CHECK_HPP
+#define TURBO_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+
+/** Same as `assert`, but the checks are kept in release mode. */
+#define CHECK(condition) \
+  do { \
+    if(!(condition)) { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      exit(EXIT_FAILURE); \
+    } \
+  } while(0)
+
+#endif
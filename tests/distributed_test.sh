@@ -0,0 +1,48 @@
+#!/bin/bash
+# Check the distributed EPS on the loopback interface: a coordinator and two worker processes must find as many solutions as the sequential search, and prove the search exhaustive.
+# Before the workers, a fake worker asks for a range of subproblems and disconnects without exploring it, so the coordinator must give this range again to the workers.
+# The connection of the fake worker uses the `/dev/tcp` redirection of bash.
+# Usage: distributed_test.sh <turbo> <chain_ne.fzn>
+
+TURBO=$1
+INSTANCE=$2
+PORT=$((40000 + $$ % 20000))
+OUTPUT=$(mktemp)
+trap 'kill $COORDINATOR $WORKERS 2>/dev/null; rm -f "$OUTPUT"' EXIT
+
+fail() {
+  echo "FAILED: $1" >&2
+  exit 1
+}
+
+EXPECTED=$("$TURBO" -arch cpu -a -t 60000 "$INSTANCE" | grep -c "^----------$")
+[ "$EXPECTED" -gt 0 ] || fail "the sequential search found no solution."
+
+"$TURBO" -arch cpu -a -v -t 60000 -sub 8 -coordinator $PORT "$INSTANCE" > "$OUTPUT" &
+COORDINATOR=$!
+
+RANGE=""
+for i in $(seq 100); do
+  RANGE=$( { { echo RANGE >&3; read -r line <&3; echo "$line"; } 3<>/dev/tcp/127.0.0.1/$PORT; } 2>/dev/null ) && break
+  sleep 0.1
+done
+case "$RANGE" in
+  RANGE*) ;;
+  *) fail "the fake worker did not receive a range of subproblems from the coordinator on port $PORT." ;;
+esac
+
+WORKERS=""
+for i in 1 2; do
+  "$TURBO" -arch cpu -a -t 60000 -p 2 -sub 8 -connect 127.0.0.1:$PORT "$INSTANCE" > /dev/null &
+  WORKERS="$WORKERS $!"
+done
+wait $COORDINATOR || fail "the coordinator exited with an error."
+wait $WORKERS
+
+grep -q "^% A worker disconnected" "$OUTPUT" || fail "the range of the fake worker ($RANGE) was not given again."
+grep -q "^==========$" "$OUTPUT" || fail "the distributed search is not exhaustive."
+FOUND=$(grep -c "^----------$" "$OUTPUT")
+if [ "$FOUND" -ne "$EXPECTED" ]; then
+  fail "expected $EXPECTED solutions as the sequential search, the distributed search found $FOUND."
+fi
+echo "OK: $FOUND solutions with a coordinator and two workers, after giving again $RANGE."
@@ -0,0 +1,63 @@
+// Copyright 2023 Pierre Talbot
+
+#include "check.hpp"
+#include "eps_granularity.hpp"
+
+void test_take_all() {
+  EPSGranularity g(1, 1);
+  CHECK(g.current_depth() == 1);
+  EPSGranularity::Subproblem s;
+  CHECK(g.take(s) && s.idx == 0 && s.depth == 1);
+  CHECK(g.take(s) && s.idx == 1 && s.depth == 1);
+  CHECK(!g.take(s));
+}
+
+void test_min_depth() {
+  // At least two subproblems per worker.
+  EPSGranularity g(0, 4);
+  CHECK(g.current_depth() == 3);
+}
+
+void test_deeper() {
+  EPSGranularity g(4, 4);
+  EPSGranularity::Subproblem s;
+  CHECK(g.take(s) && s.idx == 0 && s.depth == 4);
+  // 15 subproblems remain, less than `ADAPTIVE_EPS_MIN_SUBPROBLEMS` per worker.
+  for(int i = 0; i < 4; ++i) {
+    g.record(0, 1, false);
+  }
+  CHECK(g.current_depth() == 5);
+  CHECK(g.num_changes() == 1);
+  CHECK(g.take(s) && s.idx == 2 && s.depth == 5);
+}
+
+void test_shallower_and_alignment() {
+  EPSGranularity g(8, 1);
+  EPSGranularity::Subproblem s;
+  CHECK(g.take(s) && s.idx == 0 && s.depth == 8);
+  // The dive takes all the solving time.
+  g.record(10, 10, false);
+  CHECK(g.current_depth() == 7);
+  // The next position is not aligned on a subproblem of depth 7.
+  CHECK(g.take(s) && s.idx == 1 && s.depth == 8);
+  CHECK(g.take(s) && s.idx == 1 && s.depth == 7);
+}
+
+void test_skip_until() {
+  EPSGranularity g(4, 1);
+  EPSGranularity::Subproblem s;
+  g.skip_until(5, 4);
+  CHECK(g.take(s) && s.idx == 5 && s.depth == 4);
+  // Skipping backward has no effect.
+  g.skip_until(2, 4);
+  CHECK(g.take(s) && s.idx == 6 && s.depth == 4);
+}
+
+int main() {
+  test_take_all();
+  test_min_depth();
+  test_deeper();
+  test_shallower_and_alignment();
+  test_skip_until();
+  return 0;
+}
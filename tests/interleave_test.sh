@@ -0,0 +1,25 @@
+#!/bin/sh
+# Check that the interleaved EPS finds as many solutions as the EPS, and proves the search exhaustive.
+# The subproblems of `chain_ne.fzn` are larger than `INTERLEAVE_SLICE_NODES`, so each of them is suspended several times.
+# Usage: interleave_test.sh <turbo> <chain_ne.fzn>
+
+TURBO=$1
+INSTANCE=$2
+EXPECTED=5120
+
+count_solutions() {
+  OUTPUT=$("$TURBO" -arch cpu -a -t 60000 "$@" "$INSTANCE") || exit 1
+  if ! echo "$OUTPUT" | grep -q "^==========$"; then
+    echo "FAILED: the search with $* is not exhaustive." >&2
+    exit 1
+  fi
+  echo "$OUTPUT" | grep -c "^----------$"
+}
+
+EPS=$(count_solutions -p 4 -sub 3) || exit 1
+INTERLEAVED=$(count_solutions -p 4 -sub 3 -interleave 3) || exit 1
+if [ "$EPS" -ne "$EXPECTED" ] || [ "$INTERLEAVED" -ne "$EXPECTED" ]; then
+  echo "FAILED: expected $EXPECTED solutions, the EPS found $EPS and the interleaved EPS found $INTERLEAVED." >&2
+  exit 1
+fi
+echo "OK: $EXPECTED solutions with and without -interleave."
@@ -0,0 +1,104 @@
+// Copyright 2023 Pierre Talbot
+
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "nogoods.hpp"
+
+/** A store of intervals with the operations used by the nogoods. */
+struct TestStore {
+  std::vector<Itv> doms;
+
+  TestStore(size_t n, int lb, int ub): doms(n, Itv(Itv::LB(lb), Itv::UB(ub))) {}
+
+  const Itv& operator[](int x) const {
+    return doms[x];
+  }
+
+  void tell(int x, const Itv& dom) {
+    doms[x].tell(dom);
+  }
+
+  bool is_top() const {
+    for(const auto& dom : doms) {
+      if(dom.is_top()) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+void test_unit_nogood() {
+  TestStore store(1, 0, 10);
+  NogoodDatabase nogoods;
+  nogoods.add({{0, false, 5}});
+  CHECK(nogoods.size() == 1);
+  CHECK(nogoods.propagate(store) == 1);
+  CHECK(store[0].ub().value() == 4);
+  // The nogood is now disentailed.
+  CHECK(nogoods.propagate(store) == 0);
+}
+
+void test_binary_nogood() {
+  TestStore store(2, 0, 10);
+  NogoodDatabase nogoods;
+  nogoods.add({{0, true, 2}, {1, false, 3}});
+  CHECK(nogoods.propagate(store) == 0);
+  store.tell(0, Itv(Itv::LB::bot(), Itv::UB(2)));
+  CHECK(nogoods.propagate(store) == 1);
+  CHECK(store[1].ub().value() == 2);
+  CHECK(!store.is_top());
+}
+
+void test_watched_literals() {
+  TestStore store(3, 0, 1);
+  NogoodDatabase nogoods;
+  nogoods.add({{0, false, 1}, {1, false, 1}, {2, false, 1}});
+  store.tell(0, Itv(Itv::LB(1), Itv::UB(1)));
+  // The entailed watched literal is replaced by the literal on `x2`.
+  CHECK(nogoods.propagate(store) == 0);
+  store.tell(1, Itv(Itv::LB(1), Itv::UB(1)));
+  CHECK(nogoods.propagate(store) == 1);
+  CHECK(store[2].ub().value() == 0);
+}
+
+void test_entailed_nogood() {
+  TestStore store(2, 0, 10);
+  NogoodDatabase nogoods;
+  nogoods.add({{0, false, 5}, {1, true, 5}});
+  store.tell(0, Itv(Itv::LB(6), Itv::UB::bot()));
+  store.tell(1, Itv(Itv::LB::bot(), Itv::UB(4)));
+  nogoods.propagate(store);
+  CHECK(store.is_top());
+}
+
+void test_empty_nogood() {
+  NogoodDatabase nogoods;
+  nogoods.add({});
+  CHECK(nogoods.size() == 0);
+}
+
+void test_branch_literals() {
+  std::vector<std::pair<int, int>> bounds{{0, 10}, {0, 10}, {0, 10}};
+  TestStore store(3, 0, 10);
+  store.tell(0, Itv(Itv::LB(3), Itv::UB::bot()));
+  store.tell(2, Itv(Itv::LB(4), Itv::UB(4)));
+  std::vector<BoundLiteral> literals;
+  branch_literals(bounds, store, literals);
+  CHECK(literals.size() == 3);
+  CHECK(literals[0].var == 0 && !literals[0].upper && literals[0].value == 3);
+  CHECK(literals[1].var == 2 && !literals[1].upper && literals[1].value == 4);
+  CHECK(literals[2].var == 2 && literals[2].upper && literals[2].value == 4);
+}
+
+int main() {
+  test_unit_nogood();
+  test_binary_nogood();
+  test_watched_literals();
+  test_entailed_nogood();
+  test_empty_nogood();
+  test_branch_literals();
+  return 0;
+}
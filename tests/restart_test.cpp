@@ -0,0 +1,47 @@
+// Copyright 2023 Pierre Talbot
+
+#include "check.hpp"
+#include "restart.hpp"
+
+void test_luby() {
+  const size_t expected[] = {1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, 1};
+  for(size_t i = 0; i < sizeof(expected) / sizeof(size_t); ++i) {
+    CHECK(RestartSchedule::luby(i + 1) == expected[i]);
+  }
+  CHECK(RestartSchedule::luby(31) == 16);
+  CHECK(RestartSchedule::luby(63) == 32);
+}
+
+void test_luby_schedule() {
+  RestartSchedule schedule(RestartStrategy::LUBY, 100);
+  CHECK(schedule.next_limit() == 100);
+  CHECK(schedule.next_limit() == 100);
+  CHECK(schedule.next_limit() == 200);
+  CHECK(schedule.next_limit() == 100);
+}
+
+void test_geometric_schedule() {
+  RestartSchedule schedule(RestartStrategy::GEOMETRIC, 100);
+  size_t expected = 100;
+  double limit = 100;
+  for(int i = 0; i < 10; ++i) {
+    CHECK(schedule.next_limit() == expected);
+    limit *= RESTART_GEOMETRIC_FACTOR;
+    expected = static_cast<size_t>(std::ceil(limit));
+  }
+}
+
+void test_zero_base() {
+  RestartSchedule schedule(RestartStrategy::LUBY, 0);
+  CHECK(schedule.next_limit() == 1);
+  CHECK(schedule.next_limit() == 1);
+  CHECK(schedule.next_limit() == 2);
+}
+
+int main() {
+  test_luby();
+  test_luby_schedule();
+  test_geometric_schedule();
+  test_zero_base();
+  return 0;
+}
@@ -0,0 +1,61 @@
+// Copyright 2023 Pierre Talbot
+
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+#include "distributed_solving.hpp"
+
+#ifndef _WIN32
+
+void test_round_trip() {
+  Statistics stats;
+  stats.nodes = 1000;
+  stats.fails = 400;
+  stats.depth_max = 37;
+  stats.exhaustive = false;
+  stats.solutions = 12;
+  stats.eps_solved_subproblems = 60;
+  stats.eps_skipped_subproblems = 4;
+  stats.eps_pruned_subproblems = 3;
+  stats.eps_reused_dive_nodes = 250;
+  stats.eps_saved_fixpoint_iterations = 900;
+  stats.num_blocks_done = 1;
+  stats.fixpoint_iterations = 5000;
+  std::istringstream in(serialize_statistics(stats));
+  std::string kind;
+  in >> kind;
+  CHECK(kind == "STATS");
+  Statistics received;
+  received.solutions = 5;
+  CHECK(deserialize_statistics(in, received));
+  CHECK(received.nodes == stats.nodes);
+  CHECK(received.fails == stats.fails);
+  CHECK(received.depth_max == stats.depth_max);
+  CHECK(received.exhaustive == stats.exhaustive);
+  CHECK(received.eps_solved_subproblems == stats.eps_solved_subproblems);
+  CHECK(received.eps_skipped_subproblems == stats.eps_skipped_subproblems);
+  CHECK(received.eps_pruned_subproblems == stats.eps_pruned_subproblems);
+  CHECK(received.eps_reused_dive_nodes == stats.eps_reused_dive_nodes);
+  CHECK(received.eps_saved_fixpoint_iterations == stats.eps_saved_fixpoint_iterations);
+  CHECK(received.num_blocks_done == stats.num_blocks_done);
+  CHECK(received.fixpoint_iterations == stats.fixpoint_iterations);
+  // The solutions are counted by the coordinator when it receives them.
+  CHECK(received.solutions == 0);
+}
+
+void test_truncated() {
+  std::istringstream in("10 4 3");
+  Statistics received;
+  CHECK(!deserialize_statistics(in, received));
+}
+
+#endif
+
+int main() {
+#ifndef _WIN32
+  test_round_trip();
+  test_truncated();
+#endif
+  return 0;
+}